@@ -0,0 +1,436 @@
+#include "ContainerBench.h"
+#include "Measurement.h"
+
+#include "../include/Pair.h"
+#include "../include/String.h"
+#include "../include/UnorderedMap.h"
+#include "../include/Vector.h"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // Written after every timed call so the compiler cannot drop the work.
+  volatile uint64_t containerSink;
+
+  struct Context
+  {
+    size_t size;
+    size_t iterations;
+    // distinct keys present in the maps, and keys that are not
+    Vector<uint64_t> keys;
+    Vector<uint64_t> missingKeys;
+  };
+
+  void printHeader()
+  {
+    std::cout << std::left << std::setw(14) << "container"
+      << std::setw(16) << "operation" << std::right << std::setw(9) << "size"
+      << std::setw(14) << "ns/op" << std::setw(14) << "std ns/op"
+      << std::setw(10) << "ratio" << "\n";
+  }
+
+  // Times both bodies, each doing `operations` operations per call, and
+  // prints the per-operation medians side by side.
+  template <typename Ours, typename Std>
+  void compare(const Context& context, const char* container,
+               const char* operation, const size_t operations, Ours&& ours,
+               Std&& reference)
+  {
+    const Measurement mine = measure(container, context.size, operation,
+                                     context.iterations, ours);
+    const Measurement theirs = measure(container, context.size, operation,
+                                       context.iterations, reference);
+    const double count = static_cast<double>(operations ? operations : 1);
+    const double oursNs = mine.medianNs / count;
+    const double stdNs = theirs.medianNs / count;
+
+    std::cout << std::left << std::setw(14) << container << std::setw(16)
+      << operation << std::right << std::setw(9) << context.size
+      << std::fixed << std::setprecision(2) << std::setw(14) << oursNs
+      << std::setw(14) << stdNs << std::setw(10)
+      << (stdNs > 0 ? oursNs / stdNs : 0) << "\n";
+  }
+
+  void benchVector(const Context& context)
+  {
+    const size_t n = context.size;
+    constexpr size_t MOVES = 1000;
+    const char* name = "Vector";
+
+    Vector<uint64_t> source;
+    std::vector<uint64_t> stdSource;
+    for (size_t i = 0; i < n; i++)
+    {
+      source.pushBack(context.keys[i]);
+      stdSource.push_back(context.keys[i]);
+    }
+
+    compare(context, name, "push", n, [&]
+            {
+              Vector<uint64_t> vector;
+              for (size_t i = 0; i < n; i++)
+                vector.pushBack(i);
+              containerSink = vector.size();
+            }, [&]
+            {
+              std::vector<uint64_t> vector;
+              for (size_t i = 0; i < n; i++)
+                vector.push_back(i);
+              containerSink = vector.size();
+            });
+    compare(context, name, "push reserved", n, [&]
+            {
+              Vector<uint64_t> vector;
+              vector.reserve(n);
+              for (size_t i = 0; i < n; i++)
+                vector.pushBack(i);
+              containerSink = vector.size();
+            }, [&]
+            {
+              std::vector<uint64_t> vector;
+              vector.reserve(n);
+              for (size_t i = 0; i < n; i++)
+                vector.push_back(i);
+              containerSink = vector.size();
+            });
+    compare(context, name, "append", n, [&]
+            {
+              Vector<uint64_t> vector;
+              vector.append(source.data(), n);
+              containerSink = vector.size();
+            }, [&]
+            {
+              std::vector<uint64_t> vector;
+              vector.insert(vector.end(), stdSource.begin(), stdSource.end());
+              containerSink = vector.size();
+            });
+    compare(context, name, "copy", n, [&]
+            {
+              const Vector<uint64_t> copy(source);
+              containerSink = copy.size();
+            }, [&]
+            {
+              const std::vector<uint64_t> copy(stdSource);
+              containerSink = copy.size();
+            });
+    compare(context, name, "move", MOVES, [&]
+            {
+              for (size_t i = 0; i < MOVES; i++)
+              {
+                Vector<uint64_t> moved(std::move(source));
+                keepAlive(moved);
+                source = std::move(moved);
+              }
+              containerSink = source.size();
+            }, [&]
+            {
+              for (size_t i = 0; i < MOVES; i++)
+              {
+                std::vector<uint64_t> moved(std::move(stdSource));
+                keepAlive(moved);
+                stdSource = std::move(moved);
+              }
+              containerSink = stdSource.size();
+            });
+    compare(context, name, "iterate", n, [&]
+            {
+              uint64_t sum = 0;
+              for (const uint64_t value : source)
+                sum += value;
+              containerSink = sum;
+            }, [&]
+            {
+              uint64_t sum = 0;
+              for (const uint64_t value : stdSource)
+                sum += value;
+              containerSink = sum;
+            });
+  }
+
+  void benchUnorderedMap(const Context& context)
+  {
+    const size_t n = context.size;
+    const char* name = "UnorderedMap";
+    const Vector<uint64_t>& keys = context.keys;
+    const Vector<uint64_t>& missing = context.missingKeys;
+
+    UnorderedMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> stdMap;
+    for (size_t i = 0; i < n; i++)
+    {
+      map.insert(keys[i], i);
+      stdMap.emplace(keys[i], i);
+    }
+
+    // growing from empty rehashes on the way up
+    compare(context, name, "insert rehash", n, [&]
+            {
+              UnorderedMap<uint64_t, uint64_t> fresh;
+              for (size_t i = 0; i < n; i++)
+                fresh.insert(keys[i], i);
+              containerSink = fresh.size();
+            }, [&]
+            {
+              std::unordered_map<uint64_t, uint64_t> fresh;
+              for (size_t i = 0; i < n; i++)
+                fresh.emplace(keys[i], i);
+              containerSink = fresh.size();
+            });
+    compare(context, name, "insert reserved", n, [&]
+            {
+              UnorderedMap<uint64_t, uint64_t> fresh;
+              fresh.reserve(n);
+              for (size_t i = 0; i < n; i++)
+                fresh.insert(keys[i], i);
+              containerSink = fresh.size();
+            }, [&]
+            {
+              std::unordered_map<uint64_t, uint64_t> fresh;
+              fresh.reserve(n);
+              for (size_t i = 0; i < n; i++)
+                fresh.emplace(keys[i], i);
+              containerSink = fresh.size();
+            });
+    compare(context, name, "lookup hit", n, [&]
+            {
+              uint64_t sum = 0;
+              for (size_t i = 0; i < n; i++)
+                sum += map[keys[i]];
+              containerSink = sum;
+            }, [&]
+            {
+              uint64_t sum = 0;
+              for (size_t i = 0; i < n; i++)
+                sum += stdMap.find(keys[i])->second;
+              containerSink = sum;
+            });
+    compare(context, name, "lookup miss", n, [&]
+            {
+              size_t found = 0;
+              for (size_t i = 0; i < n; i++)
+                found += map.contains(missing[i]);
+              containerSink = found;
+            }, [&]
+            {
+              size_t found = 0;
+              for (size_t i = 0; i < n; i++)
+                found += stdMap.count(missing[i]);
+              containerSink = found;
+            });
+    // erase one present key and insert one absent key per step, then
+    // swap the two sets back so every call starts from the same map
+    compare(context, name, "erase/insert", 2 * n, [&]
+            {
+              for (size_t i = 0; i < n; i++)
+              {
+                map.erase(keys[i]);
+                map.insert(missing[i], i);
+              }
+              for (size_t i = 0; i < n; i++)
+              {
+                map.erase(missing[i]);
+                map.insert(keys[i], i);
+              }
+              containerSink = map.size();
+            }, [&]
+            {
+              for (size_t i = 0; i < n; i++)
+              {
+                stdMap.erase(keys[i]);
+                stdMap.emplace(missing[i], i);
+              }
+              for (size_t i = 0; i < n; i++)
+              {
+                stdMap.erase(missing[i]);
+                stdMap.emplace(keys[i], i);
+              }
+              containerSink = stdMap.size();
+            });
+    compare(context, name, "iterate", n, [&]
+            {
+              uint64_t sum = 0;
+              for (const Pair<const uint64_t&, const uint64_t&> entry : map)
+                sum += entry.second;
+              containerSink = sum;
+            }, [&]
+            {
+              uint64_t sum = 0;
+              for (const std::pair<const uint64_t, uint64_t>& entry : stdMap)
+                sum += entry.second;
+              containerSink = sum;
+            });
+    compare(context, name, "copy", n, [&]
+            {
+              const UnorderedMap<uint64_t, uint64_t> copy(map);
+              containerSink = copy.size();
+            }, [&]
+            {
+              const std::unordered_map<uint64_t, uint64_t> copy(stdMap);
+              containerSink = copy.size();
+            });
+  }
+
+  // For strings the size is the length; each call handles one string.
+  void benchString(const Context& context)
+  {
+    const size_t n = context.size;
+    const char* name = "String";
+    // both kinds are built from the same characters
+    Vector<char> characters(n + 1, 'x');
+    characters[n] = '\0';
+    const char* raw = characters.data();
+    const String string(raw);
+    String other(raw);
+    const std::string text(raw);
+    const std::string stdOther(raw);
+    std::string stdMoving(text);
+    constexpr size_t MOVES = 1000;
+
+    compare(context, name, "construct", 1, [&]
+            {
+              const String built(raw);
+              containerSink = built.size();
+            }, [&]
+            {
+              const std::string built(raw);
+              containerSink = built.size();
+            });
+    compare(context, name, "copy", 1, [&]
+            {
+              const String copy(string);
+              containerSink = copy.size();
+            }, [&]
+            {
+              const std::string copy(text);
+              containerSink = copy.size();
+            });
+    compare(context, name, "move", MOVES, [&]
+            {
+              for (size_t i = 0; i < MOVES; i++)
+              {
+                String moved(std::move(other));
+                keepAlive(moved);
+                other = std::move(moved);
+              }
+              containerSink = other.size();
+            }, [&]
+            {
+              for (size_t i = 0; i < MOVES; i++)
+              {
+                std::string moved(std::move(stdMoving));
+                keepAlive(moved);
+                stdMoving = std::move(moved);
+              }
+              containerSink = stdMoving.size();
+            });
+    compare(context, name, "append", 1, [&]
+            {
+              const String joined = string + "suffix";
+              containerSink = joined.size();
+            }, [&]
+            {
+              const std::string joined = text + "suffix";
+              containerSink = joined.size();
+            });
+    compare(context, name, "compare", 1, [&]
+            {
+              containerSink = string == other;
+            }, [&]
+            {
+              containerSink = text == stdOther;
+            });
+  }
+
+  void benchPair(const Context& context)
+  {
+    const size_t n = context.size;
+    const char* name = "Pair";
+    using OurPair = Pair<uint64_t, uint64_t>;
+    using StdPair = std::pair<uint64_t, uint64_t>;
+
+    // each pair type lives in its own library's vector
+    Vector<OurPair> pairs;
+    std::vector<StdPair> stdPairs;
+    for (size_t i = 0; i < n; i++)
+    {
+      pairs.emplaceBack(context.keys[i], i);
+      stdPairs.emplace_back(context.keys[i], i);
+    }
+
+    compare(context, name, "construct", n, [&]
+            {
+              Vector<OurPair> built;
+              built.reserve(n);
+              for (size_t i = 0; i < n; i++)
+                built.emplaceBack(context.keys[i], i);
+              containerSink = built.size();
+            }, [&]
+            {
+              std::vector<StdPair> built;
+              built.reserve(n);
+              for (size_t i = 0; i < n; i++)
+                built.emplace_back(context.keys[i], i);
+              containerSink = built.size();
+            });
+    compare(context, name, "copy", n, [&]
+            {
+              const Vector<OurPair> copy(pairs);
+              containerSink = copy.size();
+            }, [&]
+            {
+              const std::vector<StdPair> copy(stdPairs);
+              containerSink = copy.size();
+            });
+    compare(context, name, "compare", n, [&]
+            {
+              size_t equal = 0;
+              for (size_t i = 1; i < n; i++)
+                equal += pairs[i] == pairs[i - 1];
+              containerSink = equal;
+            }, [&]
+            {
+              size_t equal = 0;
+              for (size_t i = 1; i < n; i++)
+                equal += stdPairs[i] == stdPairs[i - 1];
+              containerSink = equal;
+            });
+  }
+}
+
+void runContainerBenchmarks(const Vector<size_t>& sizes,
+                            const size_t iterations)
+{
+  printHeader();
+  for (const size_t size : sizes)
+  {
+    Context context;
+    context.size = size;
+    // about 4M element operations per benchmark
+    const size_t scaled = (size_t{4} << 20) / size;
+    context.iterations = iterations
+                           ? iterations
+                           : scaled < 5 ? 5 : scaled > 1000 ? 1000 : scaled;
+
+    // odd keys are present, even keys are misses
+    std::mt19937_64 random(size);
+    for (size_t i = 0; i < size; i++)
+    {
+      const uint64_t key = random() << 1;
+      context.keys.pushBack(key | 1);
+      context.missingKeys.pushBack(key);
+    }
+
+    benchVector(context);
+    benchUnorderedMap(context);
+    benchString(context);
+    benchPair(context);
+  }
+}
@@ -0,0 +1,16 @@
+#ifndef CONTAINERBENCH_H
+#define CONTAINERBENCH_H
+#include <cstddef>
+
+#include "../include/Vector.h"
+
+// Times Vector, UnorderedMap, String and Pair operations next to the
+// equivalent std containers and prints ns per operation for both plus
+// their ratio. `sizes` are element counts (string lengths for String);
+// `iterations` of 0 scales the run count to the size. std containers
+// appear only as those reference cases.
+void runContainerBenchmarks(const Vector<size_t>& sizes,
+                            size_t iterations);
+
+
+#endif //CONTAINERBENCH_H
@@ -0,0 +1,223 @@
+#include "Corpus.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  // splitmix64: small, fast and good enough for test data
+  class Random
+  {
+  public:
+    explicit Random(const uint64_t seed) : state_(seed)
+    {
+    }
+
+    uint64_t next()
+    {
+      uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ z >> 30) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ z >> 27) * 0x94d049bb133111ebULL;
+      return z ^ z >> 31;
+    }
+
+    double nextUnit()
+    {
+      return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    size_t below(const size_t bound)
+    {
+      return static_cast<size_t>(next() % bound);
+    }
+
+  private:
+    uint64_t state_;
+  };
+
+  // Samples ranks 0..count-1 with probability proportional to
+  // 1 / (rank + 1)^exponent.
+  class ZipfSampler
+  {
+  public:
+    ZipfSampler(const size_t count, const double exponent) : count_(count)
+    {
+      cumulative_.resizeUninitialized(count);
+      double total = 0;
+      for (size_t rank = 0; rank < count; rank++)
+      {
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+        cumulative_[rank] = total;
+      }
+      for (size_t rank = 0; rank < count; rank++)
+        cumulative_[rank] /= total;
+    }
+
+    size_t sample(Random& random) const
+    {
+      const double target = random.nextUnit();
+      size_t low = 0;
+      size_t high = count_ - 1;
+      while (low < high)
+      {
+        const size_t middle = (low + high) / 2;
+        if (cumulative_[middle] < target)
+          low = middle + 1;
+        else
+          high = middle;
+      }
+      return low;
+    }
+
+  private:
+    size_t count_;
+    Vector<double> cumulative_;
+  };
+
+  const char* const WORDS[] = {
+    "the", "of", "and", "to", "a", "in", "is", "it", "you", "that", "he",
+    "was", "for", "on", "are", "with", "as", "his", "they", "be", "at",
+    "one", "have", "this", "from", "or", "had", "by", "word", "but", "what",
+    "some", "we", "can", "out", "other", "were", "all", "there", "when",
+    "up", "use", "your", "how", "said", "an", "each", "she", "which", "do",
+    "their", "time", "if", "will", "way", "about", "many", "then", "them",
+    "write", "would", "like", "so", "these", "her", "long", "make", "thing",
+    "see", "him", "two", "has", "look", "more", "day", "could", "go",
+    "come", "did", "number", "sound", "no", "most", "people", "my", "over",
+    "know", "water", "than", "call", "first", "who", "may", "down", "side",
+    "been", "now", "find", "encoding", "compression", "frequency", "table"
+  };
+
+  void fillText(Buffer& output, const size_t size, Random& random)
+  {
+    const size_t wordCount = sizeof(WORDS) / sizeof(WORDS[0]);
+    const ZipfSampler words(wordCount, 1.1);
+    size_t sentenceLength = 0;
+    bool capitalise = true;
+    while (output.size() < size)
+    {
+      const char* word = WORDS[words.sample(random)];
+      for (size_t i = 0; word[i] && output.size() < size; i++)
+      {
+        char c = word[i];
+        if (i == 0 && capitalise)
+          c = static_cast<char>(c - 'a' + 'A');
+        output.pushBack(static_cast<uint8_t>(c));
+      }
+      capitalise = false;
+
+      if (++sentenceLength > 6 && random.below(8) == 0)
+      {
+        output.pushBack(random.below(4) ? '.' : ',');
+        capitalise = output[output.size() - 1] == '.';
+        sentenceLength = 0;
+      }
+      output.pushBack(random.below(12) ? ' ' : '\n');
+    }
+    output.resizeUninitialized(size);
+  }
+
+  // Fixed-size little-endian records: a sequence number, a small type
+  // field, a skewed measurement and zero padding.
+  void fillBinary(Buffer& output, const size_t size, Random& random)
+  {
+    constexpr size_t RECORD_SIZE = 16;
+    const ZipfSampler types(12, 1.3);
+    uint8_t record[RECORD_SIZE];
+    for (uint32_t sequence = 0; output.size() < size; sequence++)
+    {
+      std::memset(record, 0, RECORD_SIZE);
+      for (size_t i = 0; i < 4; i++)
+        record[i] = static_cast<uint8_t>(sequence >> i * 8);
+      record[4] = static_cast<uint8_t>(types.sample(random));
+      const uint32_t measurement =
+        static_cast<uint32_t>(1000 + random.below(64) * random.below(64));
+      for (size_t i = 0; i < 4; i++)
+        record[8 + i] = static_cast<uint8_t>(measurement >> i * 8);
+
+      const size_t count = size - output.size() < RECORD_SIZE
+                             ? size - output.size()
+                             : RECORD_SIZE;
+      output.append(record, count);
+    }
+  }
+}
+
+const char* corpusName(const CorpusKind kind)
+{
+  switch (kind)
+  {
+  case CorpusKind::UNIFORM:
+    return "uniform";
+  case CorpusKind::ZIPF:
+    return "zipf";
+  case CorpusKind::SINGLE_SYMBOL:
+    return "single";
+  case CorpusKind::SHORT_RUNS:
+    return "runs";
+  case CorpusKind::TEXT:
+    return "text";
+  case CorpusKind::BINARY:
+    return "binary";
+  }
+  return "unknown";
+}
+
+bool parseCorpusName(const char* name, CorpusKind& kind)
+{
+  for (size_t i = 0; i < CORPUS_KIND_COUNT; i++)
+  {
+    const CorpusKind candidate = static_cast<CorpusKind>(i);
+    if (std::strcmp(name, corpusName(candidate)) == 0)
+    {
+      kind = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+Buffer generateCorpus(const CorpusKind kind, const size_t size,
+                      const uint64_t seed)
+{
+  Random random(seed * 0x100 + static_cast<uint64_t>(kind));
+  Buffer output;
+  output.reserve(size + 64);
+
+  switch (kind)
+  {
+  case CorpusKind::UNIFORM:
+    output.resizeUninitialized(size);
+    for (size_t i = 0; i < size; i++)
+      output[i] = static_cast<uint8_t>(random.next());
+    break;
+  case CorpusKind::ZIPF:
+    {
+      const ZipfSampler symbols(256, 1.0);
+      output.resizeUninitialized(size);
+      for (size_t i = 0; i < size; i++)
+        output[i] = static_cast<uint8_t>(symbols.sample(random));
+      break;
+    }
+  case CorpusKind::SINGLE_SYMBOL:
+    output.resizeUninitialized(size);
+    std::memset(output.data(), 'a', size);
+    break;
+  case CorpusKind::SHORT_RUNS:
+    while (output.size() < size)
+    {
+      const uint8_t symbol = static_cast<uint8_t>('A' + random.below(16));
+      for (size_t run = 1 + random.below(8); run > 0 && output.size() < size;
+           run--)
+        output.pushBack(symbol);
+    }
+    break;
+  case CorpusKind::TEXT:
+    fillText(output, size, random);
+    break;
+  case CorpusKind::BINARY:
+    fillBinary(output, size, random);
+    break;
+  }
+  return output;
+}
@@ -0,0 +1,31 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+#include <cstddef>
+#include <cstdint>
+
+#include "../include/types.h"
+
+// Synthetic inputs for the benchmarks. Generation is deterministic for a
+// given kind, size and seed, so runs on different machines see the same
+// bytes.
+enum class CorpusKind
+{
+  UNIFORM,
+  ZIPF,
+  SINGLE_SYMBOL,
+  SHORT_RUNS,
+  TEXT,
+  BINARY
+};
+
+constexpr size_t CORPUS_KIND_COUNT = 6;
+
+const char* corpusName(CorpusKind kind);
+
+// Returns false if `name` is not a corpus name.
+bool parseCorpusName(const char* name, CorpusKind& kind);
+
+Buffer generateCorpus(CorpusKind kind, size_t size, uint64_t seed = 1);
+
+
+#endif //CORPUS_H
@@ -0,0 +1,39 @@
+#include "Measurement.h"
+
+#include <algorithm>
+
+namespace
+{
+  // nearest-rank percentile of sorted samples
+  double percentile(const Vector<double>& sorted, const double fraction)
+  {
+    if (sorted.empty())
+      return 0;
+    size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+    rank = std::max<size_t>(rank, 1);
+    return sorted[std::min(rank, sorted.size()) - 1];
+  }
+}
+
+double Measurement::megabytesPerSecond() const
+{
+  if (medianNs <= 0)
+    return 0;
+  return static_cast<double>(inputSize) / 1e6 / (medianNs / 1e9);
+}
+
+Measurement summarise(const String& corpus, const size_t inputSize,
+                      const String& stage, Vector<double> samples)
+{
+  std::sort(samples.begin(), samples.end());
+
+  Measurement measurement;
+  measurement.corpus = corpus;
+  measurement.inputSize = inputSize;
+  measurement.stage = stage;
+  measurement.iterations = samples.size();
+  measurement.minNs = samples.empty() ? 0 : samples[0];
+  measurement.medianNs = percentile(samples, 0.5);
+  measurement.p99Ns = percentile(samples, 0.99);
+  return measurement;
+}
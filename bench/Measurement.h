@@ -0,0 +1,70 @@
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "../include/String.h"
+#include "../include/Vector.h"
+
+// Summary of repeated timings of one stage on one input.
+struct Measurement
+{
+  String corpus;
+  size_t inputSize = 0;
+  String stage;
+  size_t iterations = 0;
+  double minNs = 0;
+  double medianNs = 0;
+  double p99Ns = 0;
+
+  // Throughput over the original input size at the median time.
+  double megabytesPerSecond() const;
+};
+
+// Runs `body` `iterations` times after one untimed warm-up call and
+// summarises the per-call wall time.
+template <typename Body>
+Measurement measure(const String& corpus, size_t inputSize,
+                    const String& stage, size_t iterations, Body&& body);
+
+// Makes the compiler assume `value` is read and memory is modified, so
+// work whose result is otherwise unused is not optimised away.
+template <typename T>
+inline void keepAlive(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+Measurement summarise(const String& corpus, size_t inputSize,
+                      const String& stage, Vector<double> samples);
+
+template <typename Body>
+Measurement measure(const String& corpus, const size_t inputSize,
+                    const String& stage, const size_t iterations,
+                    Body&& body)
+{
+  using Clock = std::chrono::steady_clock;
+
+  body();
+  Vector<double> samples;
+  samples.reserve(iterations);
+  for (size_t i = 0; i < iterations; i++)
+  {
+    const Clock::time_point start = Clock::now();
+    body();
+    const Clock::time_point end = Clock::now();
+    samples.pushBack(static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count()));
+  }
+  return summarise(corpus, inputSize, stage, std::move(samples));
+}
+
+
+#endif //MEASUREMENT_H
@@ -0,0 +1,402 @@
+#include "Report.h"
+
+#include "../include/Pair.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+  // Just enough JSON to read back what writeJson produces.
+  struct JsonValue
+  {
+    enum class Type { NONE, NUMBER, STRING, ARRAY, OBJECT };
+
+    Type type = Type::NONE;
+    double number = 0;
+    String string;
+    Vector<JsonValue> array;
+    Vector<Pair<String, JsonValue>> object;
+
+    const JsonValue* find(const char* key) const
+    {
+      for (const Pair<String, JsonValue>& member : object)
+        if (std::strcmp(member.first.c_str(), key) == 0)
+          return &member.second;
+      return nullptr;
+    }
+  };
+
+  class JsonParser
+  {
+  public:
+    // `text` holds `size` characters followed by a terminating zero.
+    JsonParser(const char* text, const size_t size)
+      : text_(text), size_(size), pos_(0)
+    {
+    }
+
+    JsonValue parseDocument()
+    {
+      JsonValue value = parseValue();
+      skipSpace();
+      if (pos_ != size_)
+        fail("trailing characters");
+      return value;
+    }
+
+  private:
+    const char* text_;
+    size_t size_;
+    size_t pos_;
+
+    [[noreturn]] void fail(const char* what) const
+    {
+      char message[128];
+      std::snprintf(message, sizeof(message),
+                    "Malformed baseline JSON: %s at offset %zu", what, pos_);
+      throw std::runtime_error(message);
+    }
+
+    void skipSpace()
+    {
+      while (pos_ < size_ && std::isspace(
+        static_cast<unsigned char>(text_[pos_])))
+        pos_++;
+    }
+
+    bool consume(const char c)
+    {
+      skipSpace();
+      if (pos_ < size_ && text_[pos_] == c)
+      {
+        pos_++;
+        return true;
+      }
+      return false;
+    }
+
+    void expect(const char c)
+    {
+      if (!consume(c))
+        fail("unexpected character");
+    }
+
+    JsonValue parseValue()
+    {
+      skipSpace();
+      if (pos_ >= size_)
+        fail("unexpected end");
+
+      JsonValue value;
+      const char c = text_[pos_];
+      if (c == '{')
+      {
+        value.type = JsonValue::Type::OBJECT;
+        pos_++;
+        if (consume('}'))
+          return value;
+        do
+        {
+          skipSpace();
+          Pair<String, JsonValue>& member = value.object.emplaceBack();
+          member.first = parseString();
+          expect(':');
+          member.second = parseValue();
+        }
+        while (consume(','));
+        expect('}');
+      }
+      else if (c == '[')
+      {
+        value.type = JsonValue::Type::ARRAY;
+        pos_++;
+        if (consume(']'))
+          return value;
+        do
+          value.array.pushBack(parseValue());
+        while (consume(','));
+        expect(']');
+      }
+      else if (c == '"')
+      {
+        value.type = JsonValue::Type::STRING;
+        value.string = parseString();
+      }
+      else
+      {
+        const char* start = text_ + pos_;
+        char* end = nullptr;
+        value.type = JsonValue::Type::NUMBER;
+        value.number = std::strtod(start, &end);
+        if (end == start)
+          fail("expected a value");
+        pos_ += static_cast<size_t>(end - start);
+      }
+      return value;
+    }
+
+    String parseString()
+    {
+      if (pos_ >= size_ || text_[pos_] != '"')
+        fail("expected a string");
+      pos_++;
+      Vector<char> result;
+      while (pos_ < size_ && text_[pos_] != '"')
+      {
+        if (text_[pos_] == '\\' && pos_ + 1 < size_)
+          pos_++;
+        result.pushBack(text_[pos_++]);
+      }
+      if (pos_ >= size_)
+        fail("unterminated string");
+      pos_++;
+      result.pushBack('\0');
+      return String(result.data());
+    }
+  };
+
+  [[noreturn]] void missingField(const char* key)
+  {
+    char message[128];
+    std::snprintf(message, sizeof(message), "Baseline entry lacks \"%s\"",
+                  key);
+    throw std::runtime_error(message);
+  }
+
+  double numberField(const JsonValue& object, const char* key)
+  {
+    const JsonValue* value = object.find(key);
+    if (!value || value->type != JsonValue::Type::NUMBER)
+      missingField(key);
+    return value->number;
+  }
+
+  const String& stringField(const JsonValue& object, const char* key)
+  {
+    const JsonValue* value = object.find(key);
+    if (!value || value->type != JsonValue::Type::STRING)
+      missingField(key);
+    return value->string;
+  }
+
+  String label(const String& corpus, const size_t size,
+               const String& stage = String())
+  {
+    char text[256];
+    std::snprintf(text, sizeof(text), "%s %zu%s%s", corpus.c_str(), size,
+                  stage.empty() ? "" : " ", stage.c_str());
+    return String(text);
+  }
+
+  // Relative change from baseline to current; positive means larger.
+  double change(const double baseline, const double current)
+  {
+    return baseline == 0 ? 0 : (current - baseline) / baseline;
+  }
+}
+
+bool setTolerance(Tolerances& tolerances, const char* name,
+                  const double value)
+{
+  if (std::strcmp(name, "throughput") == 0)
+    tolerances.throughput = value;
+  else if (std::strcmp(name, "peak_rss") == 0)
+    tolerances.peakRss = value;
+  else if (std::strcmp(name, "compressed_size") == 0)
+    tolerances.compressedSize = value;
+  else if (std::strcmp(name, "floor_ns") == 0)
+    tolerances.floorNs = value;
+  else
+    return false;
+  return true;
+}
+
+long peakRssKb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+void writeJson(std::ostream& os, const Report& report,
+               const Tolerances& tolerances)
+{
+  os << std::setprecision(6) << "{\n"
+    << "  \"tolerances\": {\"throughput\": " << tolerances.throughput
+    << ", \"peak_rss\": " << tolerances.peakRss
+    << ", \"compressed_size\": " << tolerances.compressedSize
+    << ", \"floor_ns\": " << tolerances.floorNs << "},\n"
+    << "  \"peak_rss_kb\": " << report.peakRssKb << ",\n"
+    << "  \"corpora\": [";
+  for (size_t i = 0; i < report.corpora.size(); i++)
+  {
+    const CorpusResult& corpus = report.corpora[i];
+    os << (i ? "," : "") << "\n    {\"corpus\": \"" << corpus.corpus
+      << "\", \"size\": " << corpus.inputSize
+      << ", \"compressed_bytes\": " << corpus.compressedSize << "}";
+  }
+  os << "\n  ],\n  \"stages\": [";
+  for (size_t i = 0; i < report.measurements.size(); i++)
+  {
+    const Measurement& measurement = report.measurements[i];
+    os << (i ? "," : "") << "\n    {\"corpus\": \"" << measurement.corpus
+      << "\", \"size\": " << measurement.inputSize
+      << ", \"stage\": \"" << measurement.stage
+      << "\", \"iterations\": " << measurement.iterations
+      << ", \"min_ns\": " << std::llround(measurement.minNs)
+      << ", \"median_ns\": " << std::llround(measurement.medianNs)
+      << ", \"p99_ns\": " << std::llround(measurement.p99Ns)
+      << ", \"mbps\": " << measurement.megabytesPerSecond() << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+Report readJson(std::istream& is, Tolerances& tolerances)
+{
+  Vector<char> text;
+  char chunk[4096];
+  while (is.read(chunk, sizeof(chunk)) || is.gcount() > 0)
+    text.append(chunk, static_cast<size_t>(is.gcount()));
+  const size_t size = text.size();
+  text.pushBack('\0');
+  const JsonValue root = JsonParser(text.data(), size).parseDocument();
+  if (root.type != JsonValue::Type::OBJECT)
+    throw std::runtime_error("Baseline JSON is not an object");
+
+  if (const JsonValue* stored = root.find("tolerances"))
+    for (const Pair<String, JsonValue>& member : stored->object)
+      if (member.second.type == JsonValue::Type::NUMBER)
+        setTolerance(tolerances, member.first.c_str(), member.second.number);
+
+  Report report;
+  if (const JsonValue* rss = root.find("peak_rss_kb"))
+    report.peakRssKb = static_cast<long>(rss->number);
+
+  if (const JsonValue* corpora = root.find("corpora"))
+    for (const JsonValue& entry : corpora->array)
+    {
+      CorpusResult corpus;
+      corpus.corpus = stringField(entry, "corpus");
+      corpus.inputSize = static_cast<size_t>(numberField(entry, "size"));
+      corpus.compressedSize =
+        static_cast<size_t>(numberField(entry, "compressed_bytes"));
+      report.corpora.pushBack(corpus);
+    }
+
+  if (const JsonValue* stages = root.find("stages"))
+    for (const JsonValue& entry : stages->array)
+    {
+      Measurement measurement;
+      measurement.corpus = stringField(entry, "corpus");
+      measurement.inputSize = static_cast<size_t>(numberField(entry, "size"));
+      measurement.stage = stringField(entry, "stage");
+      measurement.iterations =
+        static_cast<size_t>(numberField(entry, "iterations"));
+      measurement.minNs = numberField(entry, "min_ns");
+      measurement.medianNs = numberField(entry, "median_ns");
+      measurement.p99Ns = numberField(entry, "p99_ns");
+      report.measurements.pushBack(measurement);
+    }
+  return report;
+}
+
+bool compareReports(const Report& baseline, const Report& current,
+                    const Tolerances& tolerances, std::ostream& log)
+{
+  bool passed = true;
+  log << std::fixed << std::setprecision(1);
+
+  for (const Measurement& before : baseline.measurements)
+  {
+    const Measurement* after = nullptr;
+    for (const Measurement& candidate : current.measurements)
+      if (candidate.corpus == before.corpus &&
+        candidate.inputSize == before.inputSize &&
+        candidate.stage == before.stage)
+        after = &candidate;
+
+    const String name = label(before.corpus, before.inputSize, before.stage);
+    if (!after)
+    {
+      log << "REGRESSION " << name << ": not measured\n";
+      passed = false;
+      continue;
+    }
+
+    const double delta = change(before.megabytesPerSecond(),
+                                after->megabytesPerSecond());
+    if (before.medianNs >= tolerances.floorNs &&
+      -delta > tolerances.throughput)
+    {
+      log << "REGRESSION " << name << ": " << before.megabytesPerSecond()
+        << " -> " << after->megabytesPerSecond() << " MB/s ("
+        << delta * 100 << "%)\n";
+      passed = false;
+    }
+  }
+
+  for (const CorpusResult& before : baseline.corpora)
+  {
+    const CorpusResult* after = nullptr;
+    for (const CorpusResult& candidate : current.corpora)
+      if (candidate.corpus == before.corpus &&
+        candidate.inputSize == before.inputSize)
+        after = &candidate;
+
+    const String name = label(before.corpus, before.inputSize);
+    if (!after)
+    {
+      log << "REGRESSION " << name << ": no compressed size\n";
+      passed = false;
+      continue;
+    }
+
+    const double delta = change(static_cast<double>(before.compressedSize),
+                                static_cast<double>(after->compressedSize));
+    if (delta > tolerances.compressedSize)
+    {
+      log << "REGRESSION " << name << ": compressed " << before.compressedSize
+        << " -> " << after->compressedSize << " bytes\n";
+      passed = false;
+    }
+  }
+
+  // only comparable when both runs could read it
+  if (baseline.peakRssKb > 0 && current.peakRssKb > 0)
+  {
+    const double delta = change(static_cast<double>(baseline.peakRssKb),
+                                static_cast<double>(current.peakRssKb));
+    if (delta > tolerances.peakRss)
+    {
+      log << "REGRESSION peak RSS: " << baseline.peakRssKb << " -> "
+        << current.peakRssKb << " KB (+" << delta * 100 << "%)\n";
+      passed = false;
+    }
+  }
+
+  log << (passed ? "No regressions against baseline\n"
+                 : "Regressions against baseline found\n");
+  return passed;
+}
@@ -0,0 +1,58 @@
+#ifndef REPORT_H
+#define REPORT_H
+#include <cstddef>
+#include <iosfwd>
+
+#include "../include/String.h"
+#include "../include/Vector.h"
+#include "Measurement.h"
+
+struct CorpusResult
+{
+  String corpus;
+  size_t inputSize = 0;
+  size_t compressedSize = 0;
+};
+
+// Everything one bench run produces; written to and read back from JSON.
+struct Report
+{
+  Vector<Measurement> measurements;
+  Vector<CorpusResult> corpora;
+  // 0 when the platform does not report it
+  long peakRssKb = 0;
+};
+
+// Allowed relative change before a metric counts as a regression:
+// throughput may drop by `throughput`, peak RSS and compressed size may
+// grow by `peakRss` and `compressedSize`. Stages whose baseline median is
+// below `floorNs` are too short to time reliably and skip the throughput
+// check.
+struct Tolerances
+{
+  double throughput = 0.30;
+  double peakRss = 0.50;
+  double compressedSize = 0.0;
+  double floorNs = 50000;
+};
+
+// Returns false if `name` is not a tolerance name.
+bool setTolerance(Tolerances& tolerances, const char* name, double value);
+
+long peakRssKb();
+
+void writeJson(std::ostream& os, const Report& report,
+               const Tolerances& tolerances);
+
+// Reads a report written by writeJson; tolerances stored in the file
+// replace the fields of `tolerances`. Throws std::runtime_error on
+// malformed input.
+Report readJson(std::istream& is, Tolerances& tolerances);
+
+// Checks every baseline entry against the current run and logs one line
+// per regression. Returns true if nothing regressed.
+bool compareReports(const Report& baseline, const Report& current,
+                    const Tolerances& tolerances, std::ostream& log);
+
+
+#endif //REPORT_H
@@ -0,0 +1,482 @@
+#include "ContainerBench.h"
+#include "Corpus.h"
+#include "Measurement.h"
+#include "Report.h"
+
+#include "../include/bit_kernels.h"
+#include "../include/Decoder.h"
+#include "../include/Encoder.h"
+#include "../include/Pair.h"
+#include "../include/String.h"
+#include "../include/Table.h"
+#include "../include/Vector.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+  // Written after each corpus so the compiler cannot drop the timed work.
+  volatile size_t benchmarkSink;
+
+  const char* const STAGES[] = {
+    "encode", "decode", "histogram", "table", "data", "pack", "unpack"
+  };
+
+  const size_t DEFAULT_SIZES[] = {1 << 10, 64 << 10, 1 << 20, 16 << 20};
+  const size_t DEFAULT_CONTAINER_SIZES[] = {16, 1 << 10, 64 << 10, 1 << 20};
+
+  struct Options
+  {
+    Vector<size_t> sizes;
+    bool containers = false;
+    Vector<CorpusKind> corpora;
+    Vector<String> stages;
+    size_t iterations = 0;
+    uint64_t seed = 1;
+    EncoderOptions encoder;
+    DecoderOptions decoder;
+    String jsonPath;
+    String baselinePath;
+    // overrides applied on top of the baseline's own tolerances
+    Vector<Pair<String, double>> tolerances;
+  };
+
+  // The first `length` characters of `text`.
+  String prefix(const char* text, const size_t length)
+  {
+    Vector<char> characters(text, text + length);
+    characters.pushBack('\0');
+    return String(characters.data());
+  }
+
+  Vector<String> split(const char* list)
+  {
+    Vector<String> items;
+    const char* start = list;
+    for (const char* c = list; ; c++)
+      if (*c == ',' || *c == '\0')
+      {
+        if (c != start)
+          items.pushBack(prefix(start, static_cast<size_t>(c - start)));
+        if (*c == '\0')
+          break;
+        start = c + 1;
+      }
+    return items;
+  }
+
+  // "4096", "64K", "16M", "1G"
+  bool parseSize(const String& text, size_t& size)
+  {
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str() || value == 0)
+      return false;
+
+    size_t multiplier = 1;
+    if (*end == 'K' || *end == 'k')
+      multiplier = size_t{1} << 10;
+    else if (*end == 'M' || *end == 'm')
+      multiplier = size_t{1} << 20;
+    else if (*end == 'G' || *end == 'g')
+      multiplier = size_t{1} << 30;
+    else if (*end != '\0')
+      return false;
+    if (multiplier != 1 && end[1] != '\0')
+      return false;
+
+    size = static_cast<size_t>(value) * multiplier;
+    return true;
+  }
+
+  String formatSize(const size_t size)
+  {
+    char text[32];
+    if (size >= size_t{1} << 30 && size % (size_t{1} << 30) == 0)
+      std::snprintf(text, sizeof(text), "%zuG", size >> 30);
+    else if (size >= size_t{1} << 20 && size % (size_t{1} << 20) == 0)
+      std::snprintf(text, sizeof(text), "%zuM", size >> 20);
+    else if (size >= size_t{1} << 10 && size % (size_t{1} << 10) == 0)
+      std::snprintf(text, sizeof(text), "%zuK", size >> 10);
+    else
+      std::snprintf(text, sizeof(text), "%zu", size);
+    return String(text);
+  }
+
+  bool isStage(const String& name)
+  {
+    for (const char* stage : STAGES)
+      if (std::strcmp(name.c_str(), stage) == 0)
+        return true;
+    return false;
+  }
+
+  void printUsage()
+  {
+    std::cerr
+      << "Usage: bench [options]\n"
+      << "  --sizes=1K,64K,1M,16M  input sizes (K, M and G suffixes)\n"
+      << "  --corpus=LIST          uniform, zipf, single, runs, text, binary\n"
+      << "  --stage=LIST           encode, decode, histogram, table, data,\n"
+      << "                         pack, unpack\n"
+      << "  --iterations=N         timed runs per stage (default: scaled to"
+      << " size)\n"
+      << "  --seed=N               corpus seed (default 1)\n"
+      << "  --streams=N            interleaved sub-streams for encode and\n"
+      << "                         decode: 1, 2, 4 or 8 (default 1)\n"
+      << "  --sync-index[=N]       write sync points every N symbols per\n"
+      << "                         sub-stream (default 64K)\n"
+      << "  --threads=N            decode threads for sync-indexed input\n"
+      << "                         (0: one per hardware thread)\n"
+      << "  --speculative          also split input without sync points\n"
+      << "                         across the decode threads\n"
+      << "  --record-size          store the input length so decode\n"
+      << "                         allocates its output once\n"
+      << "  --no-stored            code input even where a stored copy\n"
+      << "                         would be smaller\n"
+      << "  --json=FILE            write results as JSON\n"
+      << "  --compare=FILE         exit 1 if results regress against a JSON\n"
+      << "                         baseline\n"
+      << "  --containers           container microbenchmarks against std;\n"
+      << "                         --sizes are element counts (default\n"
+      << "                         16,1K,64K,1M)\n"
+      << "  --tolerance=NAME=X     allowed relative change for throughput,\n"
+      << "                         peak_rss or compressed_size; floor_ns\n"
+      << "                         skips throughput checks on faster stages\n";
+  }
+
+  bool parseOptions(const int argc, char* argv[], Options& options)
+  {
+    bool sizesGiven = false;
+    for (int i = 1; i < argc; i++)
+    {
+      const char* arg = argv[i];
+      if (std::strncmp(arg, "--sizes=", 8) == 0)
+      {
+        options.sizes.clear();
+        sizesGiven = true;
+        for (const String& item : split(arg + 8))
+        {
+          size_t size;
+          if (!parseSize(item, size))
+          {
+            std::cerr << "Invalid size: " << item << "\n";
+            return false;
+          }
+          options.sizes.pushBack(size);
+        }
+      }
+      else if (std::strncmp(arg, "--corpus=", 9) == 0)
+      {
+        for (const String& item : split(arg + 9))
+        {
+          CorpusKind kind;
+          if (!parseCorpusName(item.c_str(), kind))
+          {
+            std::cerr << "Unknown corpus: " << item << "\n";
+            return false;
+          }
+          options.corpora.pushBack(kind);
+        }
+      }
+      else if (std::strncmp(arg, "--stage=", 8) == 0)
+      {
+        for (const String& item : split(arg + 8))
+        {
+          if (!isStage(item))
+          {
+            std::cerr << "Unknown stage: " << item << "\n";
+            return false;
+          }
+          options.stages.pushBack(item);
+        }
+      }
+      else if (std::strncmp(arg, "--iterations=", 13) == 0)
+        options.iterations = std::strtoull(arg + 13, nullptr, 10);
+      else if (std::strncmp(arg, "--seed=", 7) == 0)
+        options.seed = std::strtoull(arg + 7, nullptr, 10);
+      else if (std::strncmp(arg, "--streams=", 10) == 0)
+      {
+        options.encoder.streams = std::strtoull(arg + 10, nullptr, 10);
+        if (!format::isValidStreamCount(options.encoder.streams))
+        {
+          std::cerr << "Stream count must be 1, 2, 4 or 8\n";
+          return false;
+        }
+      }
+      else if (std::strcmp(arg, "--sync-index") == 0)
+        options.encoder.syncInterval = EncoderOptions::DEFAULT_SYNC_INTERVAL;
+      else if (std::strncmp(arg, "--sync-index=", 13) == 0)
+        options.encoder.syncInterval = std::strtoull(arg + 13, nullptr, 10);
+      else if (std::strncmp(arg, "--threads=", 10) == 0)
+        options.decoder.threads = std::strtoull(arg + 10, nullptr, 10);
+      else if (std::strcmp(arg, "--speculative") == 0)
+        options.decoder.speculative = true;
+      else if (std::strcmp(arg, "--record-size") == 0)
+        options.encoder.recordSize = true;
+      else if (std::strcmp(arg, "--no-stored") == 0)
+        options.encoder.allowStored = false;
+      else if (std::strcmp(arg, "--containers") == 0)
+        options.containers = true;
+      else if (std::strncmp(arg, "--json=", 7) == 0)
+        options.jsonPath = arg + 7;
+      else if (std::strncmp(arg, "--compare=", 10) == 0)
+        options.baselinePath = arg + 10;
+      else if (std::strncmp(arg, "--tolerance=", 12) == 0)
+      {
+        const char* setting = arg + 12;
+        const char* equals = std::strchr(setting, '=');
+        const String name = equals
+                              ? prefix(setting,
+                                       static_cast<size_t>(equals - setting))
+                              : String();
+        Tolerances probe;
+        if (!equals || !setTolerance(probe, name.c_str(), 0))
+        {
+          std::cerr << "Invalid tolerance: " << setting << "\n";
+          return false;
+        }
+        options.tolerances.emplaceBack(name,
+                                       std::strtod(equals + 1, nullptr));
+      }
+      else
+      {
+        if (std::strcmp(arg, "--help") != 0)
+          std::cerr << "Unknown option: " << arg << "\n";
+        return false;
+      }
+    }
+
+    if (!sizesGiven && options.containers)
+      options.sizes = Vector<size_t>(std::begin(DEFAULT_CONTAINER_SIZES),
+                                     std::end(DEFAULT_CONTAINER_SIZES));
+    else if (!sizesGiven)
+      options.sizes = Vector<size_t>(std::begin(DEFAULT_SIZES),
+                                     std::end(DEFAULT_SIZES));
+    if (options.corpora.empty())
+      for (size_t i = 0; i < CORPUS_KIND_COUNT; i++)
+        options.corpora.pushBack(static_cast<CorpusKind>(i));
+    if (options.stages.empty())
+      for (const char* stage : STAGES)
+        options.stages.pushBack(stage);
+    return true;
+  }
+
+  // Enough runs for stable percentiles on small inputs without letting
+  // large ones dominate the wall time.
+  size_t iterationsFor(const Options& options, const size_t size)
+  {
+    if (options.iterations)
+      return options.iterations;
+    const size_t budget = (size_t{32} << 20) / size;
+    return budget < 5 ? 5 : budget > 100 ? 100 : budget;
+  }
+
+  void printHeader()
+  {
+    std::cout << std::left << std::setw(8) << "corpus" << std::right
+      << std::setw(7) << "size" << "  " << std::left << std::setw(10)
+      << "stage" << std::right << std::setw(6) << "iters"
+      << std::setw(13) << "min ms" << std::setw(13) << "median ms"
+      << std::setw(13) << "p99 ms" << std::setw(11) << "MB/s" << "\n";
+  }
+
+  void printMeasurement(const Measurement& measurement)
+  {
+    std::cout << std::left << std::setw(8) << measurement.corpus
+      << std::right << std::setw(7) << formatSize(measurement.inputSize)
+      << "  " << std::left << std::setw(10) << measurement.stage
+      << std::right << std::setw(6) << measurement.iterations
+      << std::fixed << std::setprecision(4)
+      << std::setw(13) << measurement.minNs / 1e6
+      << std::setw(13) << measurement.medianNs / 1e6
+      << std::setw(13) << measurement.p99Ns / 1e6
+      << std::setprecision(1) << std::setw(11)
+      << measurement.megabytesPerSecond() << "\n";
+  }
+
+  bool wants(const Options& options, const char* stage)
+  {
+    for (const String& name : options.stages)
+      if (std::strcmp(name.c_str(), stage) == 0)
+        return true;
+    return false;
+  }
+
+  // Benchmarks every selected stage on one corpus. Stage inputs are
+  // prepared once up front so each stage is timed in isolation.
+  bool runCorpus(const Options& options, const CorpusKind kind,
+                 const size_t size, Report& report)
+  {
+    const String name = corpusName(kind);
+    const Buffer input = generateCorpus(kind, size, options.seed);
+    const size_t iterations = iterationsFor(options, size);
+
+    size_t counts[Table::SYMBOL_COUNT];
+    Table::histogram(input.data(), input.size(), counts);
+    const Table table = Table::fromHistogram(counts);
+    const Encoded encodedData = Data::encode(table, input.data(),
+                                             input.size());
+    const Packed packedData = bit_utils::packBits(encodedData);
+
+    Packed packed;
+    Buffer decoded;
+    try
+    {
+      Encoder::encode(input.data(), input.size(), packed, options.encoder);
+      Decoder::decode(packed.data(), packed.size(), decoded,
+                      options.decoder);
+    }
+    catch (const FanoException& ex)
+    {
+      // inputs the format cannot represent are reported, not fatal
+      std::cout << std::left << std::setw(8) << name << std::right
+        << std::setw(7) << formatSize(size) << "  skipped: " << ex.what()
+        << "\n";
+      return true;
+    }
+    if (decoded.size() != input.size() ||
+      std::memcmp(decoded.data(), input.data(), input.size()) != 0)
+    {
+      std::cerr << name << " " << formatSize(size)
+        << ": round trip mismatch\n";
+      return false;
+    }
+
+    size_t sink = 0;
+    const auto record = [&](const char* stage, auto&& body)
+    {
+      if (!wants(options, stage))
+        return;
+      report.measurements.pushBack(measure(name, size, stage, iterations,
+                                           body));
+      printMeasurement(report.measurements[report.measurements.size() - 1]);
+    };
+
+    record("encode", [&]
+    {
+      Encoder::encode(input.data(), input.size(), packed, options.encoder);
+      sink += packed.size();
+    });
+    record("decode", [&]
+    {
+      Decoder::decode(packed.data(), packed.size(), decoded,
+                      options.decoder);
+      sink += decoded.size();
+    });
+    record("histogram", [&]
+    {
+      Table::histogram(input.data(), input.size(), counts);
+      sink += counts[input[0]];
+    });
+    record("table", [&]
+    {
+      sink += Table::fromHistogram(counts).getRawTable().size();
+    });
+    record("data", [&]
+    {
+      sink += Data::encode(table, input.data(), input.size()).size();
+    });
+    record("pack", [&]
+    {
+      sink += bit_utils::packBits(encodedData).size();
+    });
+    record("unpack", [&]
+    {
+      sink += Encoded::fromBytes(packedData.data(), packedData.size()).size();
+    });
+
+    CorpusResult corpus;
+    corpus.corpus = name;
+    corpus.inputSize = size;
+    corpus.compressedSize = packed.size();
+    report.corpora.pushBack(corpus);
+
+    std::cout << std::left << std::setw(8) << name << std::right
+      << std::setw(7) << formatSize(size) << "  compressed to "
+      << packed.size() << " bytes (" << std::setprecision(3)
+      << 100.0 * packed.size() / size << "%)\n";
+    benchmarkSink = sink;
+    return true;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    printUsage();
+    return 2;
+  }
+
+  std::cout << "bit kernels: "
+    << bit_kernels::name(bit_kernels::active().isa) << ", streams: "
+    << options.encoder.streams << ", sync interval: "
+    << options.encoder.syncInterval << ", decode threads: "
+    << options.decoder.threads
+    << (options.decoder.speculative ? " (speculative)" : "")
+    << (options.encoder.recordSize ? ", recorded size" : "")
+    << (options.encoder.allowStored ? "" : ", no stored blocks") << "\n";
+
+  if (options.containers)
+  {
+    runContainerBenchmarks(options.sizes, options.iterations);
+    return 0;
+  }
+
+  Report report;
+  try
+  {
+    // the baseline is read first so a bad path fails before the long run
+    Tolerances tolerances;
+    Report baseline;
+    if (!options.baselinePath.empty())
+    {
+      std::ifstream file(options.baselinePath.c_str());
+      if (!file)
+      {
+        std::cerr << "Cannot open baseline " << options.baselinePath << "\n";
+        return 2;
+      }
+      baseline = readJson(file, tolerances);
+    }
+    for (const Pair<String, double>& setting : options.tolerances)
+      setTolerance(tolerances, setting.first.c_str(), setting.second);
+
+    printHeader();
+    for (const size_t size : options.sizes)
+      for (const CorpusKind kind : options.corpora)
+        if (!runCorpus(options, kind, size, report))
+          return 1;
+    report.peakRssKb = peakRssKb();
+    std::cout << "peak RSS " << report.peakRssKb << " KB\n";
+
+    if (!options.jsonPath.empty())
+    {
+      std::ofstream file(options.jsonPath.c_str());
+      writeJson(file, report, tolerances);
+      if (!file)
+      {
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+        return 2;
+      }
+    }
+
+    if (!options.baselinePath.empty() &&
+      !compareReports(baseline, report, tolerances, std::cout))
+      return 1;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <cstddef>
+
+#include "MemoryResource.h"
+
+// Bump-pointer memory resource for jobs whose allocations all die
+// together. Memory is carved from large chunks obtained upstream and is
+// only reclaimed in bulk by reset() or release(); deallocate() just rolls
+// back the most recent allocation.
+//
+// reset() merges the chunks of the finished cycle into one chunk big
+// enough for all of them, so a repeating workload (one block after
+// another) stops allocating upstream after its first cycle.
+class Arena : public MemoryResource
+{
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 16;
+
+  explicit Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE,
+                 MemoryResource* upstream = defaultResource());
+
+  // Copies get their own empty arena with the same settings.
+  Arena(const Arena& other);
+
+  Arena(Arena&& other) noexcept;
+
+  Arena& operator=(const Arena& other);
+
+  Arena& operator=(Arena&& other) noexcept;
+
+  ~Arena() override;
+
+  void* allocate(size_t bytes, size_t alignment) override;
+
+  void deallocate(void* pointer, size_t bytes, size_t alignment) override;
+
+  // Makes all memory reusable; everything allocated so far is invalidated.
+  void reset();
+
+  // Returns every chunk upstream.
+  void release();
+
+  size_t capacity() const;
+
+  size_t chunkCount() const;
+
+private:
+  struct alignas(alignof(std::max_align_t)) Chunk
+  {
+    Chunk* next;
+    size_t size;
+  };
+
+  size_t chunkSize_;
+  MemoryResource* upstream_;
+  Chunk* head_;
+  unsigned char* cursor_;
+  unsigned char* end_;
+
+  void addChunk(size_t minimumBytes);
+
+  void rewind();
+};
+
+
+#endif //ARENA_H
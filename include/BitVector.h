@@ -0,0 +1,185 @@
+#ifndef BITVECTOR_H
+#define BITVECTOR_H
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "bit_kernels.h"
+#include "Vector.h"
+
+// Bit-packed specialisation of Vector<bool>. Bits are stored 64 per word in
+// stream order: bit i lives in word i / 64 at position i % 64, so the byte
+// view of the words matches the LSB-first layout produced by packBits.
+// Bits past size() in the last word are unspecified; every operation that
+// looks at whole words masks them out. The first word is stored inline, so
+// vectors of up to 64 bits (every code in a table) never allocate.
+template <>
+class Vector<bool>
+{
+public:
+  class Reference
+  {
+  public:
+    Reference(uint64_t* word, uint64_t mask);
+
+    operator bool() const;
+
+    Reference& operator=(bool value);
+
+    Reference& operator=(const Reference& other);
+
+  private:
+    uint64_t* word_;
+    uint64_t mask_;
+  };
+
+  // Read-only random access iterator; writes go through operator[].
+  class Iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = bool;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = bool;
+
+    Iterator(const uint64_t* words, size_t index);
+
+    bool operator*() const;
+
+    Iterator& operator++();
+
+    Iterator operator+(std::ptrdiff_t offset) const;
+
+    Iterator operator-(std::ptrdiff_t offset) const;
+
+    std::ptrdiff_t operator-(const Iterator& other) const;
+
+    bool operator==(const Iterator& other) const;
+
+    bool operator!=(const Iterator& other) const;
+
+  private:
+    friend class Vector<bool>;
+
+    static uint64_t extract(const uint64_t* words, size_t index,
+                            size_t count);
+
+    const uint64_t* words_;
+    size_t index_;
+  };
+
+  static constexpr size_t BITS_PER_WORD = 64;
+
+  Vector();
+
+  Vector(size_t count, bool value);
+
+  template <typename InputIt>
+  Vector(InputIt first, InputIt last);
+
+  Vector(Iterator first, Iterator last);
+
+  Vector(const Vector& other);
+
+  Vector& operator=(const Vector& other);
+
+  Vector(Vector&& other) noexcept;
+
+  // Copies the words when other's storage belongs to another resource,
+  // which may throw.
+  Vector& operator=(Vector&& other);
+
+  ~Vector();
+
+  static Vector fromBytes(const uint8_t* bytes, size_t byteCount);
+
+  void toBytes(uint8_t* bytes) const;
+
+  void pushBack(bool value);
+
+  void popBack();
+
+  // Appends the low `count` bits of `bits` (count <= 64), bit 0 first.
+  void appendBits(uint64_t bits, size_t count);
+
+  // Appends the codes of `count` symbols with the active bit kernel and
+  // returns how many were appended: fewer than `count` only if a symbol
+  // has no code.
+  size_t appendCodes(const uint8_t* symbols, size_t count,
+                     const bit_kernels::CodeTable& codes);
+
+  // Returns `count` bits (count <= 64) starting at `index`, bit 0 first.
+  // Like operator[], only range-checked under FANO_CHECKED_ACCESS.
+  uint64_t getBits(size_t index, size_t count) const;
+
+  Reference operator[](size_t index);
+
+  bool operator[](size_t index) const;
+
+  Reference at(size_t index);
+
+  bool at(size_t index) const;
+
+  Vector& operator+=(const Vector& other);
+
+  size_t size() const;
+
+  bool empty() const;
+
+  void clear();
+
+  size_t hash() const;
+
+  const uint64_t* words() const;
+
+  size_t wordCount() const;
+
+  bool isInline() const;
+
+  MemoryResource* resource() const;
+
+  Iterator begin() const;
+
+  Iterator end() const;
+
+  friend std::ostream& operator<<(std::ostream& os, const Vector& vec);
+
+  friend bool operator==(const Vector& lhs, const Vector& rhs);
+
+  friend bool operator!=(const Vector& lhs, const Vector& rhs);
+
+private:
+  static const size_t INLINE_CAPACITY = 1;
+
+  size_t capacity_;
+  size_t size_;
+  uint64_t* words_;
+  uint64_t inlineWord_;
+  MemoryResource* resource_;
+
+  static size_t wordsForBits(size_t bits);
+
+  static uint64_t lowMask(size_t count);
+
+  void reserveBits(size_t bits);
+
+  void releaseWords();
+
+  void resetToInline();
+
+  uint64_t lastWordMasked() const;
+};
+
+using BitVector = Vector<bool>;
+
+template <typename InputIt>
+Vector<bool>::Vector(InputIt first, InputIt last) : Vector()
+{
+  for (InputIt it = first; it != last; ++it)
+    pushBack(*it);
+}
+
+
+#endif //BITVECTOR_H
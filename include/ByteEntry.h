@@ -2,21 +2,21 @@
 #define BYTEENTRY_H
 #include <cstdint>
 
-#include "Vector.h"
+#include "Code.h"
 
 struct ByteEntry
 {
   ByteEntry();
 
-  ByteEntry(uint8_t byte, int occurrences);
+  ByteEntry(uint8_t byte, uint64_t occurrences);
 
   static void swap(ByteEntry& a, ByteEntry& b) noexcept;
 
   friend std::ostream& operator<<(std::ostream& os, const ByteEntry& obj);
 
   uint8_t byte;
-  int occurrences;
-  Vector<bool> code;
+  uint64_t occurrences;
+  Code code;
 };
 
 
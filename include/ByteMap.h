@@ -0,0 +1,498 @@
+#ifndef BYTEMAP_H
+#define BYTEMAP_H
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "UnorderedMap.h"
+
+// Direct-indexed specialisation of UnorderedMap for byte keys. The whole key
+// space fits in 256 slots, so a lookup is a presence-bit test and an indexed
+// load: no hashing, no probing. Iteration visits keys in ascending order.
+// The slot array is allocated on first insertion, from the MemoryResource
+// current at construction, and kept by clear().
+template <typename V, typename Hasher>
+class UnorderedMap<uint8_t, V, Hasher>
+{
+public:
+  static constexpr size_t KEY_COUNT = 256;
+
+  UnorderedMap();
+
+  UnorderedMap(const UnorderedMap& other);
+
+  UnorderedMap(UnorderedMap&& other) noexcept;
+
+  UnorderedMap& operator=(const UnorderedMap& other);
+
+  // Moves the values into a new slot array when other's belongs to another
+  // resource, which may throw.
+  UnorderedMap& operator=(UnorderedMap&& other);
+
+  ~UnorderedMap();
+
+  V& operator[](uint8_t key);
+
+  const V& operator[](uint8_t key) const;
+
+  void insert(uint8_t key, const V& value);
+
+  void insert(uint8_t key, V&& value);
+
+  template <typename... Args>
+  bool tryEmplace(uint8_t key, Args&&... args);
+
+  bool contains(uint8_t key) const;
+
+  bool erase(uint8_t key);
+
+  void clear();
+
+  // Every key already has a slot; kept for interface parity.
+  void reserve(size_t count);
+
+  size_t size() const;
+
+  bool empty() const;
+
+  class Iterator
+  {
+  public:
+    Iterator(const uint64_t* present, V* values, size_t index);
+
+    Iterator& operator++();
+
+    bool operator!=(const Iterator& other) const;
+
+    Pair<const uint8_t&, V&> operator*() const;
+
+  private:
+    const uint64_t* present_;
+    V* values_;
+    size_t index_;
+  };
+
+  class ConstIterator
+  {
+  public:
+    ConstIterator(const uint64_t* present, const V* values, size_t index);
+
+    ConstIterator& operator++();
+
+    bool operator!=(const ConstIterator& other) const;
+
+    Pair<const uint8_t&, const V&> operator*() const;
+
+  private:
+    const uint64_t* present_;
+    const V* values_;
+    size_t index_;
+  };
+
+  Iterator begin();
+
+  Iterator end();
+
+  ConstIterator begin() const;
+
+  ConstIterator end() const;
+
+  ConstIterator cbegin() const;
+
+  ConstIterator cend() const;
+
+  friend std::ostream& operator<<(std::ostream& os, const UnorderedMap& map)
+  {
+    os << "{\n";
+    bool first = true;
+    for (auto it = map.begin(); it != map.end(); ++it)
+    {
+      if (!first) os << ", \n";
+      os << static_cast<int>((*it).first) << ": " << (*it).second;
+      first = false;
+    }
+    os << "\n}";
+    return os;
+  }
+
+private:
+  static constexpr size_t PRESENCE_WORDS = KEY_COUNT / 64;
+
+  // Iterators hand out references to keys, which are not stored per slot.
+  static const uint8_t& keyAt(size_t index);
+
+  // First present index at or after `index`, or KEY_COUNT.
+  static size_t nextPresent(const uint64_t* present, size_t index);
+
+  uint64_t present_[PRESENCE_WORDS];
+  V* values_;
+  size_t elementCount_;
+  MemoryResource* resource_;
+
+  bool isPresent(uint8_t key) const;
+
+  void markPresent(uint8_t key);
+
+  V* slots();
+
+  void destroyAll();
+
+  void copyFrom(const UnorderedMap& other);
+
+  void moveFrom(UnorderedMap& other);
+};
+
+template <typename V>
+using ByteMap = UnorderedMap<uint8_t, V>;
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>::UnorderedMap() :
+  present_{}, values_(nullptr), elementCount_(0),
+  resource_(MemoryResource::current())
+{
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>::UnorderedMap(const UnorderedMap& other) :
+  UnorderedMap()
+{
+  copyFrom(other);
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>::UnorderedMap(UnorderedMap&& other) noexcept :
+  UnorderedMap()
+{
+  resource_ = other.resource_;
+  moveFrom(other);
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>& UnorderedMap<uint8_t, V, Hasher>::operator=(
+  const UnorderedMap& other)
+{
+  if (this != &other)
+  {
+    destroyAll();
+    copyFrom(other);
+  }
+  return *this;
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>& UnorderedMap<uint8_t, V, Hasher>::operator=(
+  UnorderedMap&& other)
+{
+  if (this != &other)
+  {
+    destroyAll();
+    moveFrom(other);
+  }
+  return *this;
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>::~UnorderedMap()
+{
+  destroyAll();
+}
+
+template <typename V, typename Hasher>
+V& UnorderedMap<uint8_t, V, Hasher>::operator[](const uint8_t key)
+{
+  if (!isPresent(key))
+  {
+    new(slots() + key) V();
+    markPresent(key);
+  }
+  return values_[key];
+}
+
+template <typename V, typename Hasher>
+const V& UnorderedMap<uint8_t, V, Hasher>::operator[](const uint8_t key) const
+{
+  if (!isPresent(key))
+    throw std::out_of_range("Key not found in const operator[]");
+
+  return values_[key];
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::insert(const uint8_t key,
+                                              const V& value)
+{
+  if (isPresent(key))
+    values_[key] = value;
+  else
+  {
+    new(slots() + key) V(value);
+    markPresent(key);
+  }
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::insert(const uint8_t key, V&& value)
+{
+  if (isPresent(key))
+    values_[key] = std::move(value);
+  else
+  {
+    new(slots() + key) V(std::move(value));
+    markPresent(key);
+  }
+}
+
+template <typename V, typename Hasher>
+template <typename... Args>
+bool UnorderedMap<uint8_t, V, Hasher>::tryEmplace(const uint8_t key,
+                                                  Args&&... args)
+{
+  if (isPresent(key))
+    return false;
+
+  new(slots() + key) V(std::forward<Args>(args)...);
+  markPresent(key);
+  return true;
+}
+
+template <typename V, typename Hasher>
+bool UnorderedMap<uint8_t, V, Hasher>::contains(const uint8_t key) const
+{
+  return isPresent(key);
+}
+
+template <typename V, typename Hasher>
+bool UnorderedMap<uint8_t, V, Hasher>::erase(const uint8_t key)
+{
+  if (!isPresent(key))
+    return false;
+
+  values_[key].~V();
+  present_[key / 64] &= ~(uint64_t{1} << key % 64);
+  --elementCount_;
+  return true;
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::clear()
+{
+  for (size_t i = nextPresent(present_, 0); i < KEY_COUNT;
+       i = nextPresent(present_, i + 1))
+    values_[i].~V();
+
+  for (size_t i = 0; i < PRESENCE_WORDS; i++)
+    present_[i] = 0;
+  elementCount_ = 0;
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::reserve(size_t)
+{
+}
+
+template <typename V, typename Hasher>
+size_t UnorderedMap<uint8_t, V, Hasher>::size() const
+{
+  return elementCount_;
+}
+
+template <typename V, typename Hasher>
+bool UnorderedMap<uint8_t, V, Hasher>::empty() const
+{
+  return elementCount_ == 0;
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>::Iterator::Iterator(
+  const uint64_t* present, V* values, const size_t index) :
+  present_(present), values_(values), index_(nextPresent(present, index))
+{
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::Iterator& UnorderedMap<
+  uint8_t, V, Hasher>::Iterator::operator++()
+{
+  index_ = nextPresent(present_, index_ + 1);
+  return *this;
+}
+
+template <typename V, typename Hasher>
+bool UnorderedMap<uint8_t, V, Hasher>::Iterator::operator!=(
+  const Iterator& other) const
+{
+  return index_ != other.index_;
+}
+
+template <typename V, typename Hasher>
+Pair<const uint8_t&, V&> UnorderedMap<uint8_t, V, Hasher>::Iterator::operator
+*() const
+{
+  return {keyAt(index_), values_[index_]};
+}
+
+template <typename V, typename Hasher>
+UnorderedMap<uint8_t, V, Hasher>::ConstIterator::ConstIterator(
+  const uint64_t* present, const V* values, const size_t index) :
+  present_(present), values_(values), index_(nextPresent(present, index))
+{
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::ConstIterator& UnorderedMap<
+  uint8_t, V, Hasher>::ConstIterator::operator++()
+{
+  index_ = nextPresent(present_, index_ + 1);
+  return *this;
+}
+
+template <typename V, typename Hasher>
+bool UnorderedMap<uint8_t, V, Hasher>::ConstIterator::operator!=(
+  const ConstIterator& other) const
+{
+  return index_ != other.index_;
+}
+
+template <typename V, typename Hasher>
+Pair<const uint8_t&, const V&> UnorderedMap<
+  uint8_t, V, Hasher>::ConstIterator::operator*() const
+{
+  return {keyAt(index_), values_[index_]};
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::Iterator UnorderedMap<
+  uint8_t, V, Hasher>::begin()
+{
+  return Iterator(present_, values_, 0);
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::Iterator UnorderedMap<
+  uint8_t, V, Hasher>::end()
+{
+  return Iterator(present_, values_, KEY_COUNT);
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::ConstIterator UnorderedMap<
+  uint8_t, V, Hasher>::begin() const
+{
+  return ConstIterator(present_, values_, 0);
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::ConstIterator UnorderedMap<
+  uint8_t, V, Hasher>::end() const
+{
+  return ConstIterator(present_, values_, KEY_COUNT);
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::ConstIterator UnorderedMap<
+  uint8_t, V, Hasher>::cbegin() const
+{
+  return begin();
+}
+
+template <typename V, typename Hasher>
+typename UnorderedMap<uint8_t, V, Hasher>::ConstIterator UnorderedMap<
+  uint8_t, V, Hasher>::cend() const
+{
+  return end();
+}
+
+template <typename V, typename Hasher>
+const uint8_t& UnorderedMap<uint8_t, V, Hasher>::keyAt(const size_t index)
+{
+  static const struct Keys
+  {
+    uint8_t values[KEY_COUNT];
+
+    Keys() : values()
+    {
+      for (size_t i = 0; i < KEY_COUNT; i++)
+        values[i] = static_cast<uint8_t>(i);
+    }
+  } keys;
+  return keys.values[index];
+}
+
+template <typename V, typename Hasher>
+size_t UnorderedMap<uint8_t, V, Hasher>::nextPresent(const uint64_t* present,
+                                                     size_t index)
+{
+  while (index < KEY_COUNT)
+  {
+    const uint64_t bits = present[index / 64] >> index % 64;
+    if (bits)
+      return index + __builtin_ctzll(bits);
+    index = (index / 64 + 1) * 64;
+  }
+  return KEY_COUNT;
+}
+
+template <typename V, typename Hasher>
+bool UnorderedMap<uint8_t, V, Hasher>::isPresent(const uint8_t key) const
+{
+  return (present_[key / 64] >> key % 64) & 1;
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::markPresent(const uint8_t key)
+{
+  present_[key / 64] |= uint64_t{1} << key % 64;
+  ++elementCount_;
+}
+
+template <typename V, typename Hasher>
+V* UnorderedMap<uint8_t, V, Hasher>::slots()
+{
+  if (!values_)
+    values_ = static_cast<V*>(resource_->allocate(KEY_COUNT * sizeof(V),
+                                                  alignof(V)));
+  return values_;
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::destroyAll()
+{
+  clear();
+  if (values_)
+    resource_->deallocate(values_, KEY_COUNT * sizeof(V), alignof(V));
+  values_ = nullptr;
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::copyFrom(const UnorderedMap& other)
+{
+  for (auto it = other.begin(); it != other.end(); ++it)
+    tryEmplace((*it).first, (*it).second);
+}
+
+template <typename V, typename Hasher>
+void UnorderedMap<uint8_t, V, Hasher>::moveFrom(UnorderedMap& other)
+{
+  if (other.resource_ != resource_)
+  {
+    for (size_t i = nextPresent(other.present_, 0); i < KEY_COUNT;
+         i = nextPresent(other.present_, i + 1))
+      tryEmplace(static_cast<uint8_t>(i), std::move(other.values_[i]));
+    other.clear();
+    return;
+  }
+
+  for (size_t i = 0; i < PRESENCE_WORDS; i++)
+  {
+    present_[i] = other.present_[i];
+    other.present_[i] = 0;
+  }
+  values_ = other.values_;
+  elementCount_ = other.elementCount_;
+  other.values_ = nullptr;
+  other.elementCount_ = 0;
+}
+#endif //BYTEMAP_H
@@ -0,0 +1,65 @@
+#ifndef CODE_H
+#define CODE_H
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// A Fano code word packed into an integer. Bit i of `bits` is the i-th bit
+// of the code in stream order, which is the order Vector<bool>::appendBits
+// consumes, so a code is written to the bit stream in one call. Bits at or
+// above `length` are always zero.
+struct Code
+{
+  // One bit is left free so key() can mark the code length.
+  static constexpr size_t MAX_LENGTH = 63;
+
+  uint64_t bits;
+  uint8_t length;
+
+  Code() : bits(0), length(0)
+  {
+  }
+
+  Code(const uint64_t bits, const uint8_t length) : bits(bits), length(length)
+  {
+  }
+
+  // Appends a bit; the caller keeps length below MAX_LENGTH.
+  void pushBack(const bool bit)
+  {
+    bits |= static_cast<uint64_t>(bit) << length;
+    ++length;
+  }
+
+  bool full() const
+  {
+    return length >= MAX_LENGTH;
+  }
+
+  // Unique integer for the (bits, length) pair: the bits with a marker bit
+  // set just above the code, so "0" and "00" stay distinct.
+  uint64_t key() const
+  {
+    return bits | uint64_t{1} << length;
+  }
+
+  friend bool operator==(const Code& lhs, const Code& rhs)
+  {
+    return lhs.bits == rhs.bits && lhs.length == rhs.length;
+  }
+
+  friend bool operator!=(const Code& lhs, const Code& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const Code& code)
+  {
+    for (size_t i = 0; i < code.length; i++)
+      os << (code.bits >> i & 1);
+    return os;
+  }
+};
+
+
+#endif //CODE_H
@@ -19,12 +19,24 @@ public:
 
   Data& operator=(const Data&);
 
-  Data& operator=(Data&&) noexcept;
+  Data& operator=(Data&&);
 
   ~Data();
 
   Encoded encode(const Table& table);
 
+  static Encoded encode(const Table& table, const uint8_t* bytes, size_t size);
+
+  // Codes symbol i into sub-stream i % streamCount. With a nonzero
+  // syncInterval, syncOffsets receives the sync points of format.h: every
+  // sub-stream's bit offset each syncInterval of its symbols, point-major.
+  static Vector<Encoded> encodeStreams(const Table& table,
+                                       const uint8_t* bytes, size_t size,
+                                       size_t streamCount,
+                                       size_t syncInterval = 0,
+                                       Vector<uint64_t>* syncOffsets =
+                                         nullptr);
+
   void decode(const Table& table, const Encoded& encodedData);
 
   const Vector<uint8_t>& getData() const;
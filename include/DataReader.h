@@ -0,0 +1,121 @@
+#ifndef DATAREADER_H
+#define DATAREADER_H
+#include <cstdint>
+
+#include "Code.h"
+#include "format.h"
+#include "Table.h"
+#include "types.h"
+#include "FanoExceptions.h"
+
+// A run of `bitCount` bits starting `bitOffset` bits into `bytes`.
+struct BitStream
+{
+  const uint8_t* bytes;
+  size_t bitOffset;
+  size_t bitCount;
+};
+
+// Lazily decodes a packed bit stream into caller-provided buffers. Only the
+// decode tables and the bit position are kept, so a single scan over the
+// decoded bytes needs no memory proportional to the input.
+//
+// Codes are resolved by indexing a lookup table with the next `width` bits
+// of the stream. The width is fixed per reader from the longest code, and
+// read() runs a kernel compiled for that width, so the mask, the number
+// of codes decoded per 64-bit refill and the unrolling are all constants.
+// Codes longer than the widest kernel go through a slow path.
+//
+// A stream split round-robin into several sub-streams (see format.h) is
+// decoded by a kernel that also fixes the stream count and takes one code
+// from each sub-stream per step, so the lookups of different sub-streams
+// do not wait on each other.
+class DataReader
+{
+public:
+  DataReader(const Table& table, const uint8_t* bytes, size_t bitOffset,
+             size_t bitCount);
+
+  // Symbol i is read from streams[i % streamCount]; streamCount must be
+  // 1, 2, 4 or 8.
+  DataReader(const Table& table, const BitStream* streams,
+             size_t streamCount);
+
+  // Reads a stored block: the bytes come back unchanged.
+  DataReader(const uint8_t* bytes, size_t size);
+
+  DataReader(const DataReader&);
+
+  DataReader(DataReader&&) noexcept;
+
+  DataReader& operator=(const DataReader&);
+
+  DataReader& operator=(DataReader&&);
+
+  ~DataReader();
+
+  // Rewinds onto other streams decoded with the same table, keeping the
+  // lookup tables; streamCount must match the reader's.
+  void restart(const BitStream* streams, size_t streamCount);
+
+  size_t read(uint8_t* output, size_t capacity);
+
+  bool atEnd() const;
+
+  // Lookup width picked for the table, in bits.
+  unsigned width() const;
+
+  // Bit offset of the next code in the first sub-stream.
+  size_t position() const;
+
+private:
+  using Kernel = size_t (DataReader::*)(uint8_t* output, size_t capacity);
+
+  struct Cursor
+  {
+    const uint8_t* bytes;
+    size_t position;
+    size_t end;
+    // bytes that may be loaded: the ones holding bits below end
+    size_t byteEnd;
+  };
+
+  Cursor cursors_[format::MAX_STREAMS];
+  size_t streamCount_;
+  // sub-stream holding the next symbol
+  size_t nextStream_;
+  unsigned width_;
+  Kernel kernel_;
+  // indexed by the next width_ bits: length << 8 | byte, or 0 when no code
+  // of at most width_ bits matches
+  Vector<uint16_t> lookup_;
+  // codes longer than width_, shortest first, and their bytes
+  Vector<Code> longCodes_;
+  Buffer longBytes_;
+
+  void openStreams(const BitStream* streams, size_t streamCount);
+
+  void buildLookup(const Table& table);
+
+  template <unsigned Width>
+  void selectKernel();
+
+  template <unsigned Width, unsigned Streams>
+  size_t readWithWidth(uint8_t* output, size_t capacity);
+
+  size_t readStored(uint8_t* output, size_t capacity);
+
+  // Up to 64 bits starting at `position`, zero past the cursor's byteEnd.
+  static uint64_t peek(const Cursor& cursor, size_t position);
+
+  // Decodes one code at the cursor without the fast path's preconditions;
+  // throws DataException on bits that do not form a code.
+  void decodeOne(Cursor& cursor, uint8_t& byte) const;
+
+  // Called when the sub-stream due next is exhausted: the input is only
+  // complete if every other one is too.
+  void checkAllStreamsEnded() const;
+};
+
+
+#endif //DATAREADER_H
@@ -6,13 +6,31 @@
 
 #include "bit_utils.h"
 #include "Data.h"
+#include "DataReader.h"
 #include "file_io.h"
+#include "format.h"
 #include "String.h"
 #include "Table.h"
 #include "Vector.h"
 #include "ScopedTimer.h"
 #include "FanoExceptions.h"
 
+struct DecoderOptions
+{
+  // Threads for files with a sync index; 0 uses one per hardware thread.
+  // Other files decode on the calling thread unless `speculative` is set.
+  // Worker threads grow the output, so the caller's current
+  // MemoryResource must be thread-safe, as the default one is.
+  size_t threads = 1;
+  // Also split single-stream files without an index across the threads:
+  // each starts at a guessed bit offset, and its output is used from the
+  // first code boundary it shares with the decode of the chunk before.
+  bool speculative = false;
+  // When the input records its original size, decode a file straight
+  // into a shared mapping of the preallocated output (Linux only).
+  bool mapOutput = false;
+};
+
 class Decoder
 {
 public:
@@ -29,9 +47,93 @@ public:
   ~Decoder();
 
   static void decode(const String& inputFilePath,
-                     const String& outputFilePath);
+                     const String& outputFilePath,
+                     const DecoderOptions& options = DecoderOptions());
+
+  static void decode(const uint8_t* input, size_t inputSize, Buffer& output,
+                     const DecoderOptions& options = DecoderOptions());
+
+  // Decodes into `output`, which must be exactly the size the input
+  // records (see EncoderOptions::recordSize) or holds as a stored block.
+  static void decode(const uint8_t* input, size_t inputSize, uint8_t* output,
+                     size_t outputSize,
+                     const DecoderOptions& options = DecoderOptions());
+
+  // The recorded original size, or a stored block's length; false when
+  // the input has neither. Reads only the fixed header fields, so the
+  // rest of the input is not checked until it is decoded.
+  static bool originalSize(const uint8_t* input, size_t inputSize,
+                           size_t& size);
+
+  static DataReader openReader(const uint8_t* input, size_t inputSize);
 
 private:
+  // The parts of an extended-format file; pointers refer into the input.
+  struct ExtendedLayout
+  {
+    size_t streamCount;
+    BitStream streams[format::MAX_STREAMS];
+    bool hasOriginalSize;
+    size_t originalSize;
+    size_t syncInterval;
+    size_t syncPointCount;
+    const uint8_t* syncOffsets;
+    // Output bytes before the last sync point: every stretch but the last.
+    size_t syncedSize;
+    Table table;
+  };
+
+  static bool isStored(const uint8_t* input, size_t inputSize);
+
+  static bool isExtended(const uint8_t* input, size_t inputSize);
+
+  static void parseLegacy(const uint8_t* input, size_t inputSize,
+                          Table& table, BitStream& data);
+
+  static void parseExtended(const uint8_t* input, size_t inputSize,
+                            ExtendedLayout& layout);
+
+  // Reads the fixed fields up to and including the original size into
+  // `layout` and returns the offset just past them.
+  static size_t parseExtendedHeader(const uint8_t* input, size_t inputSize,
+                                    uint8_t& flags, ExtendedLayout& layout);
+
+  // Decodes a parsed layout into `output`, replacing its contents.
+  static void decode(const ExtendedLayout& layout, Buffer& output,
+                     const DecoderOptions& options);
+
+  // Checks the sync index against the sub-streams parsed into `layout`
+  // and sets its syncedSize, so nothing is sized from unchecked fields.
+  static void checkSyncIndex(ExtendedLayout& layout, uint64_t totalBits);
+
+  static size_t threadCount(const DecoderOptions& options);
+
+  // Decodes a layout with a recorded size into that many bytes.
+  static void decodeExtended(const ExtendedLayout& layout, size_t threads,
+                             uint8_t* output);
+
+  // Decodes the stretches between sync points on `threads` threads into
+  // `output`, which holds every stretch but the last. The last goes to
+  // `tail`, or after the others when the original size is known and
+  // `tail` is null.
+  static void decodeSyncChunks(const ExtendedLayout& layout, size_t threads,
+                               uint8_t* output, Buffer* tail);
+
+  static void decodeSpeculatively(const Table& table, const BitStream& data,
+                                  size_t threads, Buffer& output);
+
+  static void readAll(DataReader& reader, Buffer& output);
+
+  // Decodes exactly `size` symbols that end the reader's input.
+  static void readExactly(DataReader& reader, uint8_t* output, size_t size);
+
+  // Decodes whole codes until the reader reaches `bitLimit` or its end.
+  static void readUntil(DataReader& reader, size_t bitLimit,
+                        size_t maxCodeLength, Buffer& output);
+
+  static Table readTable(const uint8_t* records, size_t tableBitSize,
+                         uint8_t bitsPerCode);
+
   static size_t getTableBitSize(uint8_t numberOfEntries, uint8_t bitsPerCode);
 };
 
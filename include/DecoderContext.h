@@ -0,0 +1,47 @@
+#ifndef DECODERCONTEXT_H
+#define DECODERCONTEXT_H
+#include <cstdint>
+
+#include "Arena.h"
+#include "Decoder.h"
+#include "EncoderContext.h"
+#include "types.h"
+#include "Vector.h"
+#include "FanoExceptions.h"
+
+// Push-style counterpart of EncoderContext: accepts the framed stream in
+// arbitrary pieces and emits decoded bytes whenever a frame completes. At
+// most one frame is buffered at a time. Per-frame working memory comes from
+// an arena that is reset after every frame.
+class DecoderContext
+{
+public:
+  DecoderContext();
+
+  DecoderContext(const DecoderContext&);
+
+  DecoderContext(DecoderContext&&) noexcept;
+
+  DecoderContext& operator=(const DecoderContext&);
+
+  DecoderContext& operator=(DecoderContext&&);
+
+  ~DecoderContext();
+
+  void update(const uint8_t* bytes, size_t size, Buffer& output);
+
+  void finish();
+
+private:
+  void decodeFrame(const uint8_t* frame, size_t size, Buffer& output);
+
+  uint8_t frameHeader_[EncoderContext::FRAME_HEADER_SIZE];
+  size_t frameHeaderFilled_;
+  size_t frameSize_;
+  Buffer frame_;
+  Buffer decoded_;
+  Arena arena_;
+};
+
+
+#endif //DECODERCONTEXT_H
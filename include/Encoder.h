@@ -6,11 +6,33 @@
 #include "bit_utils.h"
 #include "Data.h"
 #include "file_io.h"
+#include "format.h"
 #include "String.h"
 #include "Table.h"
 #include "Vector.h"
 #include "ScopedTimer.h"
 
+struct EncoderOptions
+{
+  // An 8-byte offset per sub-stream every 64K of its symbols, each at
+  // least one bit: under 0.1% of the coded data.
+  static constexpr size_t DEFAULT_SYNC_INTERVAL = 1 << 16;
+
+  // Interleaved sub-streams (1, 2, 4 or 8). One keeps the legacy format;
+  // more write the extended format from format.h, whose sub-streams the
+  // decoder reads in parallel.
+  size_t streams = 1;
+  // Symbols per sub-stream between sync points, which let the decoder
+  // split the file across threads; 0 writes no sync index.
+  size_t syncInterval = 0;
+  // Record the input length, so the decoder allocates its output once and
+  // can write it straight into a preallocated file.
+  bool recordSize = false;
+  // Copy the input into a stored block (see format.h) when coding would
+  // not make it smaller; that output ignores the options above.
+  bool allowStored = true;
+};
+
 class Encoder
 {
 public:
@@ -27,12 +49,37 @@ public:
   ~Encoder();
 
   static void encode(const String& inputFilePath,
-                     const String& outputFilePath);
+                     const String& outputFilePath,
+                     const EncoderOptions& options = EncoderOptions());
+
+  static void encode(const uint8_t* input, size_t inputSize, Packed& output,
+                     const EncoderOptions& options = EncoderOptions());
 
 private:
+  static void checkOptions(const EncoderOptions& options);
+
+  static Packed encodeWithTable(Table& table, const uint8_t* input,
+                                size_t inputSize,
+                                const EncoderOptions& options);
+
+  // Packed size of the coded output, from the table's counts and code
+  // lengths; exact for the legacy format and at most a byte per extra
+  // sub-stream over otherwise.
+  static size_t codedSize(const Table& table, const Encoded& encodedTable,
+                          size_t inputSize, const EncoderOptions& options);
+
+  static Packed packStored(const uint8_t* input, size_t inputSize);
+
   static Packed packEncodedTableAndData(const Encoded& encodedTable,
                                         const Encoded& encodedData);
 
+  static Packed packEncodedTableAndStreams(const Encoded& encodedTable,
+                                           const Vector<Encoded>& streams,
+                                           const EncoderOptions& options,
+                                           size_t inputSize,
+                                           const Vector<uint64_t>&
+                                           syncOffsets);
+
   static void getStatistics(const String& inputFilePath,
                             const String& outputFilePath, const Table& table);
 };
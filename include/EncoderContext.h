@@ -0,0 +1,50 @@
+#ifndef ENCODERCONTEXT_H
+#define ENCODERCONTEXT_H
+#include <cstdint>
+
+#include "Arena.h"
+#include "Encoder.h"
+#include "types.h"
+#include "Vector.h"
+#include "FanoExceptions.h"
+
+// Push-style encoder: input is accumulated up to blockSize bytes and every
+// complete block is emitted as an independent frame:
+//   [4B little-endian packed size][packed block as produced by Encoder]
+// Each block's working memory comes from an arena that is reset once the
+// frame is written, so steady-state blocks do not touch the heap.
+class EncoderContext
+{
+public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 16;
+  static constexpr size_t FRAME_HEADER_SIZE = 4;
+
+  explicit EncoderContext(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+  EncoderContext(const EncoderContext&);
+
+  EncoderContext(EncoderContext&&) noexcept;
+
+  EncoderContext& operator=(const EncoderContext&);
+
+  EncoderContext& operator=(EncoderContext&&);
+
+  ~EncoderContext();
+
+  void update(const uint8_t* bytes, size_t size, Packed& output);
+
+  void finish(Packed& output);
+
+  size_t blockSize() const;
+
+private:
+  void flushBlock(Packed& output);
+
+  size_t blockSize_;
+  Buffer block_;
+  Packed packed_;
+  Arena arena_;
+};
+
+
+#endif //ENCODERCONTEXT_H
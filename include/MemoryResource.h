@@ -0,0 +1,58 @@
+#ifndef MEMORYRESOURCE_H
+#define MEMORYRESOURCE_H
+#include <cstddef>
+
+
+// Allocation hook used by the containers. Every container remembers the
+// resource that was current on its thread when it was constructed and
+// returns its memory there, so a resource must outlive the containers
+// created while it was installed.
+//
+// Resource propagation follows std::pmr: copies take the current resource,
+// move construction keeps the source's resource, and move assignment
+// between containers on different resources moves the elements instead of
+// the storage.
+class MemoryResource
+{
+public:
+  virtual ~MemoryResource();
+
+  virtual void* allocate(size_t bytes, size_t alignment) = 0;
+
+  virtual void deallocate(void* pointer, size_t bytes, size_t alignment) = 0;
+
+  // operator new / operator delete; used when no scope is active.
+  static MemoryResource* defaultResource();
+
+  static MemoryResource* current();
+
+private:
+  friend class MemoryResourceScope;
+
+  static thread_local MemoryResource* current_;
+};
+
+// Installs a resource as current for the calling thread until the end of
+// the scope; scopes nest.
+class MemoryResourceScope
+{
+public:
+  explicit MemoryResourceScope(MemoryResource* resource);
+
+  MemoryResourceScope(const MemoryResourceScope&) = delete;
+
+  MemoryResourceScope& operator=(const MemoryResourceScope&) = delete;
+
+  ~MemoryResourceScope();
+
+private:
+  MemoryResource* previous_;
+};
+
+inline MemoryResource* MemoryResource::current()
+{
+  return current_ ? current_ : defaultResource();
+}
+
+
+#endif //MEMORYRESOURCE_H
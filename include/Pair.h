@@ -17,7 +17,7 @@ struct Pair
 
   Pair& operator=(const Pair& other);
 
-  Pair& operator=(Pair&& other) noexcept;
+  Pair& operator=(Pair&& other);
 
   ~Pair();
 
@@ -51,7 +51,7 @@ template <typename T1, typename T2>
 Pair<T1, T2>& Pair<T1, T2>::operator=(const Pair& other) = default;
 
 template <typename T1, typename T2>
-Pair<T1, T2>& Pair<T1, T2>::operator=(Pair&& other) noexcept = default;
+Pair<T1, T2>& Pair<T1, T2>::operator=(Pair&& other) = default;
 
 template <typename T1, typename T2>
 Pair<T1, T2>::~Pair() = default;
@@ -0,0 +1,54 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+#include <cstddef>
+#include <cstdint>
+
+
+// Per-thread hardware event counters read through Linux perf_event_open.
+// Counters are opened lazily on the calling thread the first time it takes
+// a sample; when the kernel refuses (no PMU in a VM, seccomp, restrictive
+// perf_event_paranoid) or on other platforms, sample() reports failure and
+// callers fall back to wall-clock time only. Events the CPU lacks read as
+// zero and are left out of availableEvents().
+//
+// When other users compete for the PMU the kernel multiplexes the group,
+// so it only counts part of the time; difference() scales the counts by
+// the time the group was enabled over the time it actually ran.
+class PerfCounters
+{
+public:
+  enum Event
+  {
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_MISSES,
+    LLC_MISSES,
+    EVENT_COUNT
+  };
+
+  struct Sample
+  {
+    uint64_t values[EVENT_COUNT];
+    // nanoseconds the group was enabled, and scheduled on the PMU
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+  };
+
+  // Reads the calling thread's running totals; false if counters are not
+  // available on this thread.
+  static bool sample(Sample& sample);
+
+  // Counts between two samples, scaled up for the time the group was not
+  // scheduled; false if it never ran in between, so nothing is known.
+  static bool difference(const Sample& start, const Sample& end,
+                         uint64_t* counts);
+
+  // Bit mask (1 << Event) of events opened successfully on any thread.
+  static unsigned availableEvents();
+
+  static const char* name(Event event);
+};
+
+
+#endif //PERFCOUNTERS_H
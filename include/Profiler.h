@@ -0,0 +1,101 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "PerfCounters.h"
+
+
+// Hierarchical phase profiler. ProfileScope objects nest into a per-thread
+// tree of phases (name, call count, nanoseconds, bytes processed); the trees
+// of all threads are merged by phase path when a report is produced.
+// Disabled by default, in which case a ProfileScope costs one relaxed load.
+// With counters enabled, each phase also accumulates the hardware events of
+// PerfCounters and the report adds IPC and misses per byte.
+class Profiler
+{
+public:
+  enum class Format
+  {
+    TABLE,
+    JSON
+  };
+
+  static void enable();
+
+  static void disable();
+
+  // Also samples hardware counters around every phase, where available.
+  static void enableCounters();
+
+  static bool countersEnabled();
+
+  // Arranges for a report to be written to std::cerr at exit; later calls
+  // only change the format.
+  static void reportAtExit(Format format);
+
+  static bool enabled();
+
+  // Writes the merged phase tree. Call while no phases are running.
+  static void report(std::ostream& os, Format format);
+
+  // Drops everything collected so far. Call while no phases are running.
+  static void reset();
+
+private:
+  friend class ProfileScope;
+
+  struct ThreadProfile;
+
+  struct Registry;
+
+  static std::atomic<bool> enabled_;
+
+  static std::atomic<bool> countersEnabled_;
+
+  static Registry& registry();
+
+  static ThreadProfile* threadProfile();
+
+  static void writeExitReport();
+};
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(const char* name, uint64_t bytes = 0);
+
+  ProfileScope(const ProfileScope&) = delete;
+
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+  ~ProfileScope();
+
+  // Bytes are credited to the phase when the scope closes.
+  void addBytes(uint64_t bytes);
+
+private:
+  Profiler::ThreadProfile* profile_;
+  size_t node_;
+  size_t parent_;
+  uint64_t bytes_;
+  bool counting_;
+  PerfCounters::Sample counters_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+inline bool Profiler::enabled()
+{
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+inline bool Profiler::countersEnabled()
+{
+  return countersEnabled_.load(std::memory_order_relaxed);
+}
+
+
+#endif //PROFILER_H
@@ -4,7 +4,11 @@
 #include <iostream>
 #include <string>
 
+#include "Profiler.h"
 
+
+// Prints the wall time of its scope and, when the profiler is enabled,
+// records the scope as a top-level phase named after the label.
 class ScopedTimer
 {
 public:
@@ -16,7 +20,8 @@ public:
 
 private:
   std::string label_;
-  std::chrono::high_resolution_clock::time_point start_;
+  ProfileScope phase_;
+  std::chrono::steady_clock::time_point start_;
   bool isSuppressed = false;
 };
 
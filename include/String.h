@@ -4,6 +4,8 @@
 #include <cstring>
 #include <iostream>
 
+#include "MemoryResource.h"
+
 class String
 {
 public:
@@ -17,7 +19,9 @@ public:
 
   String& operator=(const String& other);
 
-  String& operator=(String&& other) noexcept;
+  // Copies when other's characters belong to another resource, which may
+  // throw.
+  String& operator=(String&& other);
 
   ~String();
 
@@ -45,10 +49,10 @@ public:
     char buffer[BUFFER_SIZE];
     is >> buffer;
 
-    delete[] string.data_;
+    string.releaseData();
 
     string.length_ = std::strlen(buffer);
-    string.data_ = new char[string.length_ + 1];
+    string.data_ = string.allocateData(string.length_);
     std::strcpy(string.data_, buffer);
 
     return is;
@@ -59,6 +63,11 @@ private:
 
   char* data_;
   size_t length_;
+  MemoryResource* resource_;
+
+  char* allocateData(size_t length);
+
+  void releaseData();
 };
 
 #endif //STRING_H
@@ -4,17 +4,23 @@
 
 #include "bit_utils.h"
 #include "ByteEntry.h"
+#include "Code.h"
 #include "UnorderedMap.h"
 #include "Vector.h"
 #include "Pair.h"
+#include "Profiler.h"
 #include "types.h"
 #include "FanoExceptions.h"
 
 class Table
 {
 public:
+  static constexpr size_t SYMBOL_COUNT = 256;
+
   explicit Table(const Buffer& buffer);
 
+  Table(const uint8_t* bytes, size_t size);
+
   Table();
 
   Table(const Table&);
@@ -23,7 +29,7 @@ public:
 
   Table& operator=(const Table&);
 
-  Table& operator=(Table&&) noexcept;
+  Table& operator=(Table&&);
 
   ~Table();
 
@@ -33,31 +39,50 @@ public:
 
   double calculateEntropy() const;
 
-  const Encoded& getCodeForByte(uint8_t byte) const;
+  const Code& getCodeForByte(uint8_t byte) const;
+
+  bool getByteByCode(const Code& code, uint8_t& outByte) const;
+
+  const ByteMap<ByteEntry>& getRawTable() const;
 
-  bool getByteByCode(const Encoded& code, uint8_t& outByte) const;
+  // Writes the number of occurrences of every byte value to
+  // counts[0..SYMBOL_COUNT).
+  static void histogram(const uint8_t* bytes, size_t size, size_t* counts);
 
-  const UnorderedMap<uint8_t, ByteEntry>& getRawTable() const;
+  // Builds the code table from histogram() output; throws TableException
+  // if every count is zero.
+  static Table fromHistogram(const size_t* counts);
 
 private:
-  void countByteFrequencies(const Buffer& buffer);
+  // every distinct byte fits inline, so building the code table does not
+  // touch the heap
+  using TableVector = Vector<ByteEntry, 256>;
 
-  Vector<ByteEntry> toVector() const;
+  void build(const uint8_t* bytes, size_t size);
 
-  static void sortTableVectorByFrequency(Vector<ByteEntry>& tableVector);
+  void buildFromHistogram(const size_t* counts);
 
-  static void buildFanoCodes(Vector<ByteEntry>& tableVector, size_t start,
+  TableVector toVector() const;
+
+  static void sortTableVectorByFrequency(TableVector& tableVector);
+
+  static void buildFanoCodes(TableVector& tableVector, size_t start,
                              size_t end);
 
-  void fromVector(Vector<ByteEntry>& tableVector);
+  void fromVector(TableVector& tableVector);
 
   size_t findMaxCodeLength();
 
   void buildReverseTable();
 
-  UnorderedMap<uint8_t, ByteEntry> table_;
-  UnorderedMap<Vector<bool>, uint8_t, BoolVectorHasher<Vector<bool>>>
-  reverseTable_;
+  // Reads a `width`-bit table field: zero padding, a marker one, then the
+  // code bits.
+  static Code parseNormalizedCode(const Encoded& bits, size_t start,
+                                  size_t width);
+
+  ByteMap<ByteEntry> table_;
+  // keyed by Code::key()
+  UnorderedMap<uint64_t, uint8_t> reverseTable_;
 };
 
 
@@ -1,9 +1,19 @@
 #ifndef UNORDEREDMAP_H
 #define UNORDEREDMAP_H
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <ostream>
+#include <stdexcept>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
+#include "MemoryResource.h"
 #include "Pair.h"
+#include "Vector.h"
 
 template <typename K>
 struct DefaultHasher
@@ -32,6 +42,21 @@ struct BoolVectorHasher
   }
 };
 
+template <>
+struct BoolVectorHasher<Vector<bool>>
+{
+  size_t operator()(const Vector<bool>& key) const
+  {
+    return key.hash();
+  }
+};
+
+// Swiss-table style open addressing map. A separate array of control bytes
+// (one per slot: empty, deleted, or 7 bits of the key's hash) is probed a
+// group of 16 slots at a time, with SSE2 when available; keys and values
+// live in their own arrays and are only touched on a control-byte match.
+// Tombstones are dropped whenever the table is rebuilt. Storage comes from
+// the MemoryResource current at construction.
 template <typename K, typename V, typename Hasher = DefaultHasher<K>>
 class UnorderedMap
 {
@@ -44,7 +69,9 @@ public:
 
   UnorderedMap& operator=(const UnorderedMap& other);
 
-  UnorderedMap& operator=(UnorderedMap&& other) noexcept;
+  // Moves the entries into new slots when other's belong to another
+  // resource, which may throw.
+  UnorderedMap& operator=(UnorderedMap&& other);
 
   ~UnorderedMap();
 
@@ -54,28 +81,30 @@ public:
 
   void insert(const K& key, const V& value);
 
+  void insert(const K& key, V&& value);
+
+  // Constructs the value from args only if the key is absent; returns
+  // whether an insertion took place.
+  template <typename... Args>
+  bool tryEmplace(const K& key, Args&&... args);
+
   bool contains(const K& key) const;
 
   bool erase(const K& key);
 
   void clear();
 
+  void reserve(size_t count);
+
   size_t size() const;
 
   bool empty() const;
 
-  struct Entry
-  {
-    bool occupied = false;
-    bool deleted = false;
-    K key;
-    V value;
-  };
-
   class Iterator
   {
   public:
-    Iterator(Entry* ptr, Entry* end);
+    Iterator(const uint8_t* control, const K* keys, V* values, size_t index,
+             size_t capacity);
 
     Iterator& operator++();
 
@@ -84,8 +113,11 @@ public:
     Pair<const K&, V&> operator*() const;
 
   private:
-    Entry* current_;
-    Entry* end_;
+    const uint8_t* control_;
+    const K* keys_;
+    V* values_;
+    size_t index_;
+    size_t capacity_;
 
     void skipToValid();
   };
@@ -93,7 +125,8 @@ public:
   class ConstIterator
   {
   public:
-    ConstIterator(const Entry* ptr, const Entry* end);
+    ConstIterator(const uint8_t* control, const K* keys, const V* values,
+                  size_t index, size_t capacity);
 
     ConstIterator& operator++();
 
@@ -102,8 +135,11 @@ public:
     Pair<const K&, const V&> operator*() const;
 
   private:
-    const Entry* current_;
-    const Entry* end_;
+    const uint8_t* control_;
+    const K* keys_;
+    const V* values_;
+    size_t index_;
+    size_t capacity_;
 
     void skipToValid();
   };
@@ -124,13 +160,12 @@ public:
   {
     os << "{\n";
     bool first = true;
-    for (size_t i = 0; i < map.tableSize_; ++i)
+    for (size_t i = 0; i < map.capacity_; ++i)
     {
-      const Entry& entry = map.table_[i];
-      if (entry.occupied && !entry.deleted)
+      if (isFull(map.control_[i]))
       {
         if (!first) os << ", \n";
-        os << static_cast<int>(entry.key) << ": " << entry.value;
+        os << static_cast<int>(map.keys_[i]) << ": " << map.values_[i];
         first = false;
       }
     }
@@ -139,44 +174,79 @@ public:
   }
 
 private:
-  Entry* table_;
-  size_t tableSize_;
+  static constexpr size_t GROUP_WIDTH = 16;
+  static constexpr uint8_t EMPTY = 0x80;
+  static constexpr uint8_t DELETED = 0xFE;
+  static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+  // Control bytes are only allocated once something is inserted; until
+  // then every lookup probes this all-empty group.
+  static const uint8_t* emptyGroup();
+
+  static bool isFull(uint8_t control);
+
+  static size_t mixHash(const K& key);
+
+  static uint32_t matchByte(const uint8_t* group, uint8_t value);
+
+  static uint32_t matchEmpty(const uint8_t* group);
+
+  static uint32_t matchEmptyOrDeleted(const uint8_t* group);
+
+  static int lowestBit(uint32_t mask);
+
+  static size_t capacityFor(size_t count);
+
+  uint8_t* control_;
+  K* keys_;
+  V* values_;
+  size_t capacity_;
   size_t elementCount_;
-  static constexpr float MAX_LOAD_FACTOR = 0.75f;
-  static constexpr size_t INITIAL_CAPACITY = 16;
+  size_t growthLeft_;
+  MemoryResource* resource_;
+
+  size_t find(const K& key) const;
+
+  size_t findFreeSlot(size_t hash) const;
+
+  // Returns the slot for key with the key constructed in it; the value is
+  // constructed by the caller when `inserted` is true.
+  size_t findOrClaim(const K& key, bool& inserted);
 
-  size_t findSlot(const K& key) const;
+  void rehash(size_t newCapacity);
 
-  V& insertOrGet(const K& key);
+  void allocate(size_t capacity);
 
-  void rehash();
+  void releaseStorage(uint8_t* control, K* keys, V* values, size_t capacity);
+
+  void destroyAll();
+
+  void copyFrom(const UnorderedMap& other);
+
+  void moveFrom(UnorderedMap& other);
 };
 
 template <typename K, typename V, typename Hasher>
-UnorderedMap<K, V, Hasher>::UnorderedMap() : tableSize_(INITIAL_CAPACITY),
-                                             elementCount_(0)
+UnorderedMap<K, V, Hasher>::UnorderedMap() :
+  control_(const_cast<uint8_t*>(emptyGroup())), keys_(nullptr),
+  values_(nullptr), capacity_(0), elementCount_(0), growthLeft_(0),
+  resource_(MemoryResource::current())
 {
-  table_ = new Entry[tableSize_];
 }
 
 template <typename K, typename V, typename Hasher>
 UnorderedMap<K, V, Hasher>::UnorderedMap(const UnorderedMap& other) :
-  tableSize_(other.tableSize_),
-  elementCount_(other.elementCount_)
+  UnorderedMap()
 {
-  table_ = new Entry[tableSize_];
-  for (size_t i = 0; i < tableSize_; i++)
-    table_[i] = other.table_[i];
+  copyFrom(other);
 }
 
 template <typename K, typename V, typename Hasher>
 UnorderedMap<K, V, Hasher>::UnorderedMap(UnorderedMap&& other) noexcept :
-  table_(other.table_), tableSize_(other.tableSize_),
-  elementCount_(other.elementCount_)
+  UnorderedMap()
 {
-  other.table_ = nullptr;
-  other.tableSize_ = 0;
-  other.elementCount_ = 0;
+  resource_ = other.resource_;
+  moveFrom(other);
 }
 
 template <typename K, typename V, typename Hasher>
@@ -185,29 +255,20 @@ UnorderedMap<K, V, Hasher>& UnorderedMap<K, V, Hasher>::operator=(
 {
   if (this != &other)
   {
-    delete[] table_;
-    tableSize_ = other.tableSize_;
-    elementCount_ = other.elementCount_;
-    table_ = new Entry[tableSize_];
-    for (size_t i = 0; i < tableSize_; i++)
-      table_[i] = other.table_[i];
+    destroyAll();
+    copyFrom(other);
   }
   return *this;
 }
 
 template <typename K, typename V, typename Hasher>
 UnorderedMap<K, V, Hasher>& UnorderedMap<K, V, Hasher>::operator=(
-  UnorderedMap&& other) noexcept
+  UnorderedMap&& other)
 {
   if (this != &other)
   {
-    delete[] table_;
-    table_ = other.table_;
-    tableSize_ = other.tableSize_;
-    elementCount_ = other.elementCount_;
-    other.table_ = nullptr;
-    other.tableSize_ = 0;
-    other.elementCount_ = 0;
+    destroyAll();
+    moveFrom(other);
   }
   return *this;
 }
@@ -215,60 +276,115 @@ UnorderedMap<K, V, Hasher>& UnorderedMap<K, V, Hasher>::operator=(
 template <typename K, typename V, typename Hasher>
 UnorderedMap<K, V, Hasher>::~UnorderedMap()
 {
-  delete[] table_;
+  destroyAll();
 }
 
 template <typename K, typename V, typename Hasher>
 V& UnorderedMap<K, V, Hasher>::operator[](const K& key)
 {
-  return insertOrGet(key);
+  bool inserted;
+  const size_t index = findOrClaim(key, inserted);
+  if (inserted)
+    new(values_ + index) V();
+  return values_[index];
 }
 
 template <typename K, typename V, typename Hasher>
 const V& UnorderedMap<K, V, Hasher>::operator[](const K& key) const
 {
-  size_t index = findSlot(key);
-  if (!table_[index].occupied || table_[index].deleted)
+  const size_t index = find(key);
+  if (index == NOT_FOUND)
     throw std::out_of_range("Key not found in const operator[]");
 
-  return table_[index].value;
+  return values_[index];
 }
 
 template <typename K, typename V, typename Hasher>
 void UnorderedMap<K, V, Hasher>::insert(const K& key, const V& value)
 {
-  insertOrGet(key) = value;
+  bool inserted;
+  const size_t index = findOrClaim(key, inserted);
+  if (inserted)
+    new(values_ + index) V(value);
+  else
+    values_[index] = value;
+}
+
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::insert(const K& key, V&& value)
+{
+  bool inserted;
+  const size_t index = findOrClaim(key, inserted);
+  if (inserted)
+    new(values_ + index) V(std::move(value));
+  else
+    values_[index] = std::move(value);
+}
+
+template <typename K, typename V, typename Hasher>
+template <typename... Args>
+bool UnorderedMap<K, V, Hasher>::tryEmplace(const K& key, Args&&... args)
+{
+  bool inserted;
+  const size_t index = findOrClaim(key, inserted);
+  if (inserted)
+    new(values_ + index) V(std::forward<Args>(args)...);
+  return inserted;
 }
 
 template <typename K, typename V, typename Hasher>
 bool UnorderedMap<K, V, Hasher>::contains(const K& key) const
 {
-  size_t index = findSlot(key);
-  return table_[index].occupied && !table_[index].deleted;
+  return find(key) != NOT_FOUND;
 }
 
 template <typename K, typename V, typename Hasher>
 bool UnorderedMap<K, V, Hasher>::erase(const K& key)
 {
-  size_t index = findSlot(key);
+  const size_t index = find(key);
+  if (index == NOT_FOUND)
+    return false;
+
+  keys_[index].~K();
+  values_[index].~V();
+  --elementCount_;
 
-  if (table_[index].occupied && !table_[index].deleted)
+  // a group that still has an empty slot never lets a probe continue past
+  // it, so the erased slot can become empty instead of a tombstone
+  const uint8_t* group = control_ + index / GROUP_WIDTH * GROUP_WIDTH;
+  if (matchEmpty(group))
   {
-    table_[index].deleted = true;
-    --elementCount_;
-    return true;
+    control_[index] = EMPTY;
+    ++growthLeft_;
   }
+  else
+    control_[index] = DELETED;
 
-  return false;
+  return true;
 }
 
 template <typename K, typename V, typename Hasher>
 void UnorderedMap<K, V, Hasher>::clear()
 {
-  delete[] table_;
-  tableSize_ = INITIAL_CAPACITY;
-  table_ = new Entry[tableSize_];
+  for (size_t i = 0; i < capacity_; i++)
+    if (isFull(control_[i]))
+    {
+      keys_[i].~K();
+      values_[i].~V();
+    }
+
+  if (capacity_)
+    std::memset(control_, EMPTY, capacity_);
   elementCount_ = 0;
+  growthLeft_ = capacity_ - capacity_ / 8;
+}
+
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::reserve(const size_t count)
+{
+  const size_t needed = capacityFor(count);
+  if (needed > capacity_)
+    rehash(needed);
 }
 
 template <typename K, typename V, typename Hasher>
@@ -284,9 +400,10 @@ bool UnorderedMap<K, V, Hasher>::empty() const
 }
 
 template <typename K, typename V, typename Hasher>
-UnorderedMap<
-  K, V, Hasher>::Iterator::Iterator(Entry* ptr, Entry* end) : current_(ptr),
-  end_(end)
+UnorderedMap<K, V, Hasher>::Iterator::Iterator(
+  const uint8_t* control, const K* keys, V* values, const size_t index,
+  const size_t capacity) : control_(control), keys_(keys), values_(values),
+                           index_(index), capacity_(capacity)
 {
   skipToValid();
 }
@@ -295,7 +412,7 @@ template <typename K, typename V, typename Hasher>
 typename UnorderedMap<K, V, Hasher>::Iterator& UnorderedMap<
   K, V, Hasher>::Iterator::operator++()
 {
-  ++current_;
+  ++index_;
   skipToValid();
   return *this;
 }
@@ -304,25 +421,27 @@ template <typename K, typename V, typename Hasher>
 bool UnorderedMap<K, V, Hasher>::Iterator::operator!=(
   const Iterator& other) const
 {
-  return current_ != other.current_;
+  return index_ != other.index_;
 }
 
 template <typename K, typename V, typename Hasher>
 Pair<const K&, V&> UnorderedMap<K, V, Hasher>::Iterator::operator*() const
 {
-  return {current_->key, current_->value};
+  return {keys_[index_], values_[index_]};
 }
 
 template <typename K, typename V, typename Hasher>
 void UnorderedMap<K, V, Hasher>::Iterator::skipToValid()
 {
-  while (current_ != end_ && (!current_->occupied || current_->deleted))
-    ++current_;
+  while (index_ < capacity_ && !isFull(control_[index_]))
+    ++index_;
 }
 
 template <typename K, typename V, typename Hasher>
 UnorderedMap<K, V, Hasher>::ConstIterator::ConstIterator(
-  const Entry* ptr, const Entry* end) : current_(ptr), end_(end)
+  const uint8_t* control, const K* keys, const V* values, const size_t index,
+  const size_t capacity) : control_(control), keys_(keys), values_(values),
+                           index_(index), capacity_(capacity)
 {
   skipToValid();
 }
@@ -331,7 +450,7 @@ template <typename K, typename V, typename Hasher>
 typename UnorderedMap<K, V, Hasher>::ConstIterator& UnorderedMap<
   K, V, Hasher>::ConstIterator::operator++()
 {
-  ++current_;
+  ++index_;
   skipToValid();
   return *this;
 }
@@ -340,48 +459,48 @@ template <typename K, typename V, typename Hasher>
 bool UnorderedMap<K, V, Hasher>::ConstIterator::operator!=(
   const ConstIterator& other) const
 {
-  return current_ != other.current_;
+  return index_ != other.index_;
 }
 
 template <typename K, typename V, typename Hasher>
 Pair<const K&, const V&> UnorderedMap<K, V, Hasher>::ConstIterator::operator
 *() const
 {
-  return {current_->key, current_->value};
+  return {keys_[index_], values_[index_]};
 }
 
 template <typename K, typename V, typename Hasher>
 void UnorderedMap<K, V, Hasher>::ConstIterator::skipToValid()
 {
-  while (current_ != end_ && (!current_->occupied || current_->deleted))
-    ++current_;
+  while (index_ < capacity_ && !isFull(control_[index_]))
+    ++index_;
 }
 
 template <typename K, typename V, typename Hasher>
 typename UnorderedMap<K, V, Hasher>::Iterator UnorderedMap<
   K, V, Hasher>::begin()
 {
-  return Iterator(table_, table_ + tableSize_);
+  return Iterator(control_, keys_, values_, 0, capacity_);
 }
 
 template <typename K, typename V, typename Hasher>
 typename UnorderedMap<K, V, Hasher>::Iterator UnorderedMap<K, V, Hasher>::end()
 {
-  return Iterator(table_ + tableSize_, table_ + tableSize_);
+  return Iterator(control_, keys_, values_, capacity_, capacity_);
 }
 
 template <typename K, typename V, typename Hasher>
 typename UnorderedMap<K, V, Hasher>::ConstIterator UnorderedMap<
   K, V, Hasher>::begin() const
 {
-  return ConstIterator(table_, table_ + tableSize_);
+  return ConstIterator(control_, keys_, values_, 0, capacity_);
 }
 
 template <typename K, typename V, typename Hasher>
 typename UnorderedMap<K, V, Hasher>::ConstIterator UnorderedMap<
   K, V, Hasher>::end() const
 {
-  return ConstIterator(table_ + tableSize_, table_ + tableSize_);
+  return ConstIterator(control_, keys_, values_, capacity_, capacity_);
 }
 
 template <typename K, typename V, typename Hasher>
@@ -399,66 +518,271 @@ typename UnorderedMap<K, V, Hasher>::ConstIterator UnorderedMap<
 }
 
 template <typename K, typename V, typename Hasher>
-size_t UnorderedMap<K, V, Hasher>::findSlot(const K& key) const
+const uint8_t* UnorderedMap<K, V, Hasher>::emptyGroup()
 {
-  size_t mask = tableSize_ - 1;
-  size_t hash = Hasher{}(key) & mask;
-  size_t step = 1;
-  while (table_[hash].occupied &&
-    (table_[hash].deleted || !(table_[hash].key == key)))
+  alignas(GROUP_WIDTH) static const uint8_t group[GROUP_WIDTH] = {
+    EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+    EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY
+  };
+  return group;
+}
+
+template <typename K, typename V, typename Hasher>
+bool UnorderedMap<K, V, Hasher>::isFull(const uint8_t control)
+{
+  return (control & 0x80) == 0;
+}
+
+template <typename K, typename V, typename Hasher>
+size_t UnorderedMap<K, V, Hasher>::mixHash(const K& key)
+{
+  // spread weak hashes (DefaultHasher is the identity for small keys) over
+  // all bits before splitting into group index and control byte
+  uint64_t hash = Hasher{}(key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return static_cast<size_t>(hash);
+}
+
+template <typename K, typename V, typename Hasher>
+uint32_t UnorderedMap<K, V, Hasher>::matchByte(const uint8_t* group,
+                                               const uint8_t value)
+{
+#ifdef __SSE2__
+  const __m128i control =
+    _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+  const __m128i match = _mm_cmpeq_epi8(
+    control, _mm_set1_epi8(static_cast<char>(value)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(match));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < GROUP_WIDTH; i++)
+    if (group[i] == value)
+      mask |= 1u << i;
+  return mask;
+#endif
+}
+
+template <typename K, typename V, typename Hasher>
+uint32_t UnorderedMap<K, V, Hasher>::matchEmpty(const uint8_t* group)
+{
+  return matchByte(group, EMPTY);
+}
+
+template <typename K, typename V, typename Hasher>
+uint32_t UnorderedMap<K, V, Hasher>::matchEmptyOrDeleted(const uint8_t* group)
+{
+#ifdef __SSE2__
+  const __m128i control =
+    _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(control));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < GROUP_WIDTH; i++)
+    if (!isFull(group[i]))
+      mask |= 1u << i;
+  return mask;
+#endif
+}
+
+template <typename K, typename V, typename Hasher>
+int UnorderedMap<K, V, Hasher>::lowestBit(const uint32_t mask)
+{
+  return __builtin_ctz(mask);
+}
+
+template <typename K, typename V, typename Hasher>
+size_t UnorderedMap<K, V, Hasher>::capacityFor(const size_t count)
+{
+  // keep the load factor at or below 7/8
+  size_t capacity = GROUP_WIDTH;
+  while (capacity - capacity / 8 < count)
+    capacity *= 2;
+  return capacity;
+}
+
+template <typename K, typename V, typename Hasher>
+size_t UnorderedMap<K, V, Hasher>::find(const K& key) const
+{
+  const size_t hash = mixHash(key);
+  const uint8_t tag = static_cast<uint8_t>(hash & 0x7F);
+  const size_t groupMask = capacity_ ? capacity_ / GROUP_WIDTH - 1 : 0;
+  size_t group = (hash >> 7) & groupMask;
+
+  // triangular probing visits every group once when their count is a
+  // power of two
+  for (size_t step = 1;; step++)
   {
-    hash = hash + step * step & mask;
-    step++;
+    const uint8_t* control = control_ + group * GROUP_WIDTH;
+    for (uint32_t match = matchByte(control, tag); match; match &= match - 1)
+    {
+      const size_t index = group * GROUP_WIDTH + lowestBit(match);
+      if (keys_[index] == key)
+        return index;
+    }
+    if (matchEmpty(control) || step > groupMask)
+      return NOT_FOUND;
+    group = (group + step) & groupMask;
   }
-  return hash;
 }
 
 template <typename K, typename V, typename Hasher>
-V& UnorderedMap<K, V, Hasher>::insertOrGet(const K& key)
+size_t UnorderedMap<K, V, Hasher>::findFreeSlot(const size_t hash) const
 {
-  if (static_cast<float>(elementCount_ + 1) / tableSize_ > MAX_LOAD_FACTOR)
-    rehash();
+  const size_t groupMask = capacity_ / GROUP_WIDTH - 1;
+  size_t group = (hash >> 7) & groupMask;
+  for (size_t step = 1;; step++)
+  {
+    const uint32_t free = matchEmptyOrDeleted(control_ + group * GROUP_WIDTH);
+    if (free)
+      return group * GROUP_WIDTH + lowestBit(free);
+    group = (group + step) & groupMask;
+  }
+}
 
-  size_t mask = tableSize_ - 1;
-  size_t hash = Hasher{}(key) & mask;
-  size_t step = 1;
-  size_t firstDeleted = tableSize_;
+template <typename K, typename V, typename Hasher>
+size_t UnorderedMap<K, V, Hasher>::findOrClaim(const K& key, bool& inserted)
+{
+  size_t index = find(key);
+  if (index != NOT_FOUND)
+  {
+    inserted = false;
+    return index;
+  }
 
-  while (table_[hash].occupied)
+  const size_t hash = mixHash(key);
+  index = capacity_ ? findFreeSlot(hash) : NOT_FOUND;
+  if (index == NOT_FOUND || (growthLeft_ == 0 && control_[index] == EMPTY))
   {
-    if (!table_[hash].deleted && table_[hash].key == key)
-      return table_[hash].value;
+    // drop tombstones in place when they are what fills the table,
+    // otherwise grow
+    if (capacity_ == 0)
+      rehash(GROUP_WIDTH);
+    else
+      rehash(elementCount_ * 2 < capacity_ ? capacity_ : capacity_ * 2);
+    index = findFreeSlot(hash);
+  }
+
+  if (control_[index] == EMPTY)
+    --growthLeft_;
+  control_[index] = static_cast<uint8_t>(hash & 0x7F);
+  new(keys_ + index) K(key);
+  ++elementCount_;
+  inserted = true;
+  return index;
+}
 
-    if (table_[hash].deleted && firstDeleted == tableSize_)
-      firstDeleted = hash;
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::rehash(const size_t newCapacity)
+{
+  uint8_t* oldControl = control_;
+  K* oldKeys = keys_;
+  V* oldValues = values_;
+  const size_t oldCapacity = capacity_;
 
-    hash = hash + step * step & mask;
-    step++;
-  }
+  allocate(newCapacity);
 
-  size_t target = firstDeleted != tableSize_ ? firstDeleted : hash;
-  table_[target].occupied = true;
-  table_[target].deleted = false;
-  table_[target].key = key;
-  elementCount_++;
-  return table_[target].value;
+  for (size_t i = 0; i < oldCapacity; i++)
+    if (isFull(oldControl[i]))
+    {
+      const size_t hash = mixHash(oldKeys[i]);
+      const size_t index = findFreeSlot(hash);
+      control_[index] = static_cast<uint8_t>(hash & 0x7F);
+      new(keys_ + index) K(std::move(oldKeys[i]));
+      new(values_ + index) V(std::move(oldValues[i]));
+      oldKeys[i].~K();
+      oldValues[i].~V();
+      --growthLeft_;
+    }
+
+  if (oldCapacity)
+    releaseStorage(oldControl, oldKeys, oldValues, oldCapacity);
 }
 
 template <typename K, typename V, typename Hasher>
-void UnorderedMap<K, V, Hasher>::rehash()
+void UnorderedMap<K, V, Hasher>::allocate(const size_t capacity)
 {
-  const size_t newCapacity = tableSize_ * 2;
-  Entry* oldTable = table_;
-  const size_t oldSize = tableSize_;
+  control_ = static_cast<uint8_t*>(resource_->allocate(capacity,
+                                                        GROUP_WIDTH));
+  std::memset(control_, EMPTY, capacity);
+  keys_ = static_cast<K*>(resource_->allocate(capacity * sizeof(K),
+                                              alignof(K)));
+  values_ = static_cast<V*>(resource_->allocate(capacity * sizeof(V),
+                                                alignof(V)));
+  capacity_ = capacity;
+  growthLeft_ = capacity - capacity / 8;
+}
 
-  table_ = new Entry[newCapacity];
-  tableSize_ = newCapacity;
-  elementCount_ = 0;
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::releaseStorage(uint8_t* control, K* keys,
+                                                V* values,
+                                                const size_t capacity)
+{
+  resource_->deallocate(values, capacity * sizeof(V), alignof(V));
+  resource_->deallocate(keys, capacity * sizeof(K), alignof(K));
+  resource_->deallocate(control, capacity, GROUP_WIDTH);
+}
 
-  for (size_t i = 0; i < oldSize; i++)
-    if (oldTable[i].occupied && !oldTable[i].deleted)
-      insert(oldTable[i].key, oldTable[i].value);
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::destroyAll()
+{
+  clear();
+  if (capacity_)
+    releaseStorage(control_, keys_, values_, capacity_);
+  control_ = const_cast<uint8_t*>(emptyGroup());
+  keys_ = nullptr;
+  values_ = nullptr;
+  capacity_ = 0;
+  growthLeft_ = 0;
+}
 
-  delete[] oldTable;
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::copyFrom(const UnorderedMap& other)
+{
+  if (other.elementCount_ == 0)
+    return;
+
+  allocate(other.capacity_);
+  std::memcpy(control_, other.control_, capacity_);
+  for (size_t i = 0; i < capacity_; i++)
+    if (isFull(control_[i]))
+    {
+      new(keys_ + i) K(other.keys_[i]);
+      new(values_ + i) V(other.values_[i]);
+    }
+  elementCount_ = other.elementCount_;
+  growthLeft_ = other.growthLeft_;
+}
+
+template <typename K, typename V, typename Hasher>
+void UnorderedMap<K, V, Hasher>::moveFrom(UnorderedMap& other)
+{
+  if (other.resource_ != resource_)
+  {
+    // the slots belong to another resource: move the entries instead
+    reserve(other.elementCount_);
+    for (size_t i = 0; i < other.capacity_; i++)
+      if (isFull(other.control_[i]))
+        tryEmplace(other.keys_[i], std::move(other.values_[i]));
+    other.clear();
+    return;
+  }
+
+  control_ = other.control_;
+  keys_ = other.keys_;
+  values_ = other.values_;
+  capacity_ = other.capacity_;
+  elementCount_ = other.elementCount_;
+  growthLeft_ = other.growthLeft_;
+
+  other.control_ = const_cast<uint8_t*>(emptyGroup());
+  other.keys_ = nullptr;
+  other.values_ = nullptr;
+  other.capacity_ = 0;
+  other.elementCount_ = 0;
+  other.growthLeft_ = 0;
 }
+
+#include "ByteMap.h"
 #endif //UNORDEREDMAP_H
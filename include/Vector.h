@@ -1,11 +1,47 @@
 #ifndef VECTOR_H
 #define VECTOR_H
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+#include "MemoryResource.h"
+
+
+// Raw inline element buffer used by Vector while its contents fit; empty
+// (and optimised away) when InlineCapacity is 0.
+template <class T, size_t InlineCapacity>
+struct VectorInlineStorage
+{
+  T* inlineData() { return reinterpret_cast<T*>(bytes_); }
+
+  const T* inlineData() const { return reinterpret_cast<const T*>(bytes_); }
+
+  alignas(T) unsigned char bytes_[InlineCapacity * sizeof(T)];
+};
 
 template <class T>
-class Vector
+struct VectorInlineStorage<T, 0>
+{
+  T* inlineData() { return nullptr; }
+
+  const T* inlineData() const { return nullptr; }
+};
+
+// Dynamic array. With InlineCapacity > 0 the first InlineCapacity elements
+// live inside the object and the heap is only touched once it grows past
+// that; the default-constructed vector never allocates.
+//
+// Storage is raw memory: only the first size() slots hold constructed
+// elements. Trivially copyable element types are copied with memcpy and
+// memmove, everything else is constructed in place; growth moves elements
+// (falling back to copies only for types whose move may throw). Heap
+// storage comes from the MemoryResource current at construction.
+template <class T, size_t InlineCapacity = 0>
+class Vector : private VectorInlineStorage<T, InlineCapacity>
 {
 public:
   Vector();
@@ -19,9 +55,12 @@ public:
 
   Vector& operator=(const Vector& other);
 
+  // Takes over other's storage and resource.
   Vector(Vector&& other) noexcept;
 
-  Vector& operator=(Vector&& other) noexcept;
+  // Keeps this vector's resource: from inline storage or another resource
+  // the elements move into storage allocated here, which may throw.
+  Vector& operator=(Vector&& other);
 
   ~Vector();
 
@@ -31,18 +70,45 @@ public:
 
   void pushBack(const T& value);
 
+  void pushBack(T&& value);
+
+  template <typename... Args>
+  T& emplaceBack(Args&&... args);
+
   void popBack();
 
+  void reserve(size_t capacity);
+
+  // Changes the size without initialising new trivially copyable elements
+  // (other types are value-initialised); meant to be overwritten right away.
+  void resizeUninitialized(size_t size);
+
+  void append(const T* values, size_t count);
+
+  void insert(size_t position, const T* values, size_t count);
+
+  // Bounds-checked only when FANO_CHECKED_ACCESS is defined (tests and
+  // debug builds); at() always checks.
   T& operator[](size_t index);
 
   const T& operator[](size_t index) const;
 
+  T& at(size_t index);
+
+  const T& at(size_t index) const;
+
   Vector& operator+=(const Vector& other);
 
   size_t size() const;
 
+  size_t capacity() const;
+
   bool empty() const;
 
+  bool isInline() const;
+
+  MemoryResource* resource() const;
+
   void clear();
 
   T* begin();
@@ -85,139 +151,265 @@ public:
   }
 
 private:
+  static constexpr bool IS_TRIVIAL = std::is_trivially_copyable<T>::value;
+
   static const size_t DEFAULT_CAPACITY = 4;
 
   size_t capacity_;
   size_t size_;
   T* data_;
+  MemoryResource* resource_;
+
+  static void copyConstruct(T* destination, const T* source, size_t count);
+
+  static void moveConstruct(T* destination, T* source, size_t count);
+
+  static void destroy(T* first, size_t count);
+
+  // Moves the elements into storage for at least `capacity` elements.
+  void reallocate(size_t capacity);
 
-  void resize();
+  void grow(size_t minimumCapacity);
+
+  void releaseStorage();
 };
 
 
-template <class T>
-Vector<T>::Vector() : capacity_(DEFAULT_CAPACITY), size_(0), data_(new T[capacity_])
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>::Vector() : capacity_(InlineCapacity), size_(0),
+                                      data_(this->inlineData()),
+                                      resource_(MemoryResource::current())
 {
 }
 
-template <class T>
-Vector<T>::Vector(const size_t count, const T& value)
-  : capacity_(count), size_(count), data_(new T[capacity_])
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>::Vector(const size_t count, const T& value)
+  : Vector()
 {
-  for (size_t i = 0; i < size_; i++)
-    data_[i] = value;
+  reserve(count);
+  for (size_t i = 0; i < count; i++)
+    new(data_ + i) T(value);
+  size_ = count;
 }
 
-template <class T>
+template <class T, size_t InlineCapacity>
 template <typename InputIt>
-Vector<T>::Vector(InputIt first, InputIt last)
+Vector<T, InlineCapacity>::Vector(InputIt first, InputIt last) : Vector()
 {
-  size_ = capacity_ = std::distance(first, last);
-  data_ = new T[capacity_];
-  size_t i = 0;
-
-  for (InputIt it = first; it != last; ++it, i++)
-    data_[i] = *it;
+  reserve(std::distance(first, last));
+  for (InputIt it = first; it != last; ++it, size_++)
+    new(data_ + size_) T(*it);
 }
 
-template <class T>
-Vector<T>::Vector(const Vector& other) : capacity_(other.capacity_),
-                                        size_(other.size_),
-                                        data_(new T[other.capacity_])
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>::Vector(const Vector& other) : Vector()
 {
-  for (size_t i = 0; i < other.size_; i++)
-    data_[i] = other.data_[i];
+  append(other.data_, other.size_);
 }
 
-template <class T>
-Vector<T>& Vector<T>::operator=(const Vector& other)
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>& Vector<T, InlineCapacity>::operator=(
+  const Vector& other)
 {
   if (this != &other)
   {
-    delete[] data_;
-
-    capacity_ = other.capacity_;
-    size_ = other.size_;
-    data_ = new T[capacity_];
-
-    for (size_t i = 0; i < size_; i++)
-      data_[i] = other.data_[i];
+    clear();
+    append(other.data_, other.size_);
   }
   return *this;
 }
 
-template <class T>
-Vector<T>::Vector(Vector&& other) noexcept : capacity_(other.capacity_),
-                                            size_(other.size_),
-                                            data_(other.data_)
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>::Vector(Vector&& other) noexcept : Vector()
 {
-  other.data_ = nullptr;
-  other.size_ = 0;
-  other.capacity_ = 0;
+  resource_ = other.resource_;
+  *this = std::move(other);
 }
 
-template <class T>
-Vector<T>& Vector<T>::operator=(Vector&& other) noexcept
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>& Vector<T, InlineCapacity>::operator=(
+  Vector&& other)
 {
   if (this != &other)
   {
-    delete[] data_;
-    capacity_ = other.capacity_;
-    size_ = other.size_;
-    data_ = other.data_;
-
-    other.data_ = nullptr;
-    other.size_ = 0;
-    other.capacity_ = 0;
+    clear();
+    if (other.isInline() || other.resource_ != resource_)
+    {
+      // the storage cannot change hands; keep ours and move the elements
+      reserve(other.size_);
+      for (size_t i = 0; i < other.size_; i++)
+        new(data_ + i) T(std::move(other.data_[i]));
+      size_ = other.size_;
+      other.clear();
+    }
+    else
+    {
+      releaseStorage();
+      capacity_ = other.capacity_;
+      size_ = other.size_;
+      data_ = other.data_;
+      other.capacity_ = InlineCapacity;
+      other.size_ = 0;
+      other.data_ = other.inlineData();
+    }
   }
   return *this;
 }
 
-template <class T>
-Vector<T>::~Vector()
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>::~Vector()
 {
-  delete[] data_;
+  clear();
+  releaseStorage();
 }
 
-template <class T>
-T* Vector<T>::data()
+template <class T, size_t InlineCapacity>
+T* Vector<T, InlineCapacity>::data()
 {
   return data_;
 }
 
-template <class T>
-const T* Vector<T>::data() const
+template <class T, size_t InlineCapacity>
+const T* Vector<T, InlineCapacity>::data() const
 {
   return data_;
 }
 
-template <class T>
-void Vector<T>::pushBack(const T& value)
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::pushBack(const T& value)
+{
+  emplaceBack(value);
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::pushBack(T&& value)
+{
+  emplaceBack(std::move(value));
+}
+
+template <class T, size_t InlineCapacity>
+template <typename... Args>
+T& Vector<T, InlineCapacity>::emplaceBack(Args&&... args)
 {
   if (size_ >= capacity_)
-    resize();
+  {
+    // the arguments may refer to the storage about to be released
+    T value(std::forward<Args>(args)...);
+    grow(size_ + 1);
+    return *new(data_ + size_++) T(std::move(value));
+  }
 
-  data_[size_++] = value;
+  return *new(data_ + size_++) T(std::forward<Args>(args)...);
 }
 
-template <class T>
-void Vector<T>::popBack()
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::popBack()
 {
   if (size_ > 0)
-    size_--;
+    destroy(data_ + --size_, 1);
 }
 
-template <class T>
-T& Vector<T>::operator[](size_t index)
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::reserve(const size_t capacity)
 {
-  if (index >= size_)
+  if (capacity > capacity_)
+    reallocate(capacity);
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::resizeUninitialized(const size_t size)
+{
+  if (size < size_)
+  {
+    destroy(data_ + size, size_ - size);
+    size_ = size;
+    return;
+  }
+
+  grow(size);
+  if (!IS_TRIVIAL)
+    for (size_t i = size_; i < size; i++)
+      new(data_ + i) T();
+  size_ = size;
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::append(const T* values, const size_t count)
+{
+  insert(size_, values, count);
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::insert(const size_t position, const T* values,
+                                       const size_t count)
+{
+  if (position > size_)
     throw std::out_of_range("Index out of range");
+  if (count == 0)
+    return;
+
+  if (values + count > data_ && values < data_ + size_)
+  {
+    // inserting a slice of ourselves: take a copy before storage moves
+    const Vector slice(values, values + count);
+    insert(position, slice.data_, count);
+    return;
+  }
+
+  grow(size_ + count);
+  T* gap = data_ + position;
+  const size_t tail = size_ - position;
 
+  if (IS_TRIVIAL)
+  {
+    std::memmove(static_cast<void*>(gap + count), gap, tail * sizeof(T));
+    std::memcpy(static_cast<void*>(gap), values, count * sizeof(T));
+    size_ += count;
+    return;
+  }
+
+  // shift the tail back, constructing into raw slots past the old end
+  T* const oldEnd = data_ + size_;
+  for (size_t i = tail; i-- > 0;)
+  {
+    T* target = gap + count + i;
+    if (target >= oldEnd)
+      new(target) T(std::move(gap[i]));
+    else
+      *target = std::move(gap[i]);
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    if (gap + i >= oldEnd)
+      new(gap + i) T(values[i]);
+    else
+      gap[i] = values[i];
+  }
+  size_ += count;
+}
+
+template <class T, size_t InlineCapacity>
+T& Vector<T, InlineCapacity>::operator[](size_t index)
+{
+#ifdef FANO_CHECKED_ACCESS
+  return at(index);
+#else
   return data_[index];
+#endif
 }
 
-template <class T>
-const T& Vector<T>::operator[](size_t index) const
+template <class T, size_t InlineCapacity>
+const T& Vector<T, InlineCapacity>::operator[](size_t index) const
+{
+#ifdef FANO_CHECKED_ACCESS
+  return at(index);
+#else
+  return data_[index];
+#endif
+}
+
+template <class T, size_t InlineCapacity>
+T& Vector<T, InlineCapacity>::at(size_t index)
 {
   if (index >= size_)
     throw std::out_of_range("Index out of range");
@@ -225,55 +417,150 @@ const T& Vector<T>::operator[](size_t index) const
   return data_[index];
 }
 
-template <class T>
-Vector<T>& Vector<T>::operator+=(const Vector& other)
+template <class T, size_t InlineCapacity>
+const T& Vector<T, InlineCapacity>::at(size_t index) const
 {
-  for (const T& el : other)
-    pushBack(el);
+  if (index >= size_)
+    throw std::out_of_range("Index out of range");
+
+  return data_[index];
+}
 
+template <class T, size_t InlineCapacity>
+Vector<T, InlineCapacity>& Vector<T, InlineCapacity>::operator+=(
+  const Vector& other)
+{
+  append(other.data_, other.size_);
   return *this;
 }
 
-template <class T>
-size_t Vector<T>::size() const
+template <class T, size_t InlineCapacity>
+size_t Vector<T, InlineCapacity>::size() const
 {
   return size_;
 }
 
-template <class T>
-bool Vector<T>::empty() const
+template <class T, size_t InlineCapacity>
+size_t Vector<T, InlineCapacity>::capacity() const
+{
+  return capacity_;
+}
+
+template <class T, size_t InlineCapacity>
+bool Vector<T, InlineCapacity>::empty() const
 {
   return size_ == 0;
 }
 
-template <class T>
-void Vector<T>::clear()
+template <class T, size_t InlineCapacity>
+bool Vector<T, InlineCapacity>::isInline() const
 {
+  return data_ == this->inlineData();
+}
+
+template <class T, size_t InlineCapacity>
+MemoryResource* Vector<T, InlineCapacity>::resource() const
+{
+  return resource_;
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::clear()
+{
+  destroy(data_, size_);
   size_ = 0;
 }
 
-template <class T>
-T* Vector<T>::begin() { return data_; }
+template <class T, size_t InlineCapacity>
+T* Vector<T, InlineCapacity>::begin() { return data_; }
 
-template <class T>
-T* Vector<T>::end() { return data_ + size_; }
+template <class T, size_t InlineCapacity>
+T* Vector<T, InlineCapacity>::end() { return data_ + size_; }
 
-template <class T>
-const T* Vector<T>::begin() const { return data_; }
+template <class T, size_t InlineCapacity>
+const T* Vector<T, InlineCapacity>::begin() const { return data_; }
 
-template <class T>
-const T* Vector<T>::end() const { return data_ + size_; }
+template <class T, size_t InlineCapacity>
+const T* Vector<T, InlineCapacity>::end() const { return data_ + size_; }
 
-template <class T>
-void Vector<T>::resize()
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::copyConstruct(T* destination, const T* source,
+                                              const size_t count)
 {
-  capacity_ *= 2;
-  T* newdata_ = new T[capacity_];
+  if (IS_TRIVIAL)
+  {
+    if (count)
+      std::memcpy(static_cast<void*>(destination), source, count * sizeof(T));
+    return;
+  }
 
-  for (size_t i = 0; i < size_; i++)
-    newdata_[i] = data_[i];
+  for (size_t i = 0; i < count; i++)
+    new(destination + i) T(source[i]);
+}
 
-  delete[] data_;
-  data_ = newdata_;
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::moveConstruct(T* destination, T* source,
+                                              const size_t count)
+{
+  if (IS_TRIVIAL)
+  {
+    if (count)
+      std::memcpy(static_cast<void*>(destination), source, count * sizeof(T));
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++)
+    new(destination + i) T(std::move_if_noexcept(source[i]));
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::destroy(T* first, const size_t count)
+{
+  if (!std::is_trivially_destructible<T>::value)
+    for (size_t i = 0; i < count; i++)
+      first[i].~T();
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::reallocate(const size_t capacity)
+{
+  const bool toInline = capacity <= InlineCapacity;
+  T* newData = toInline
+                 ? this->inlineData()
+                 : static_cast<T*>(
+                   resource_->allocate(capacity * sizeof(T), alignof(T)));
+  if (newData == data_)
+    return;
+
+  moveConstruct(newData, data_, size_);
+  destroy(data_, size_);
+  releaseStorage();
+
+  data_ = newData;
+  capacity_ = toInline ? InlineCapacity : capacity;
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::grow(const size_t minimumCapacity)
+{
+  if (minimumCapacity <= capacity_)
+    return;
+
+  size_t newCapacity = capacity_ ? capacity_ * 2 : DEFAULT_CAPACITY;
+  if (newCapacity < minimumCapacity)
+    newCapacity = minimumCapacity;
+  reallocate(newCapacity);
+}
+
+template <class T, size_t InlineCapacity>
+void Vector<T, InlineCapacity>::releaseStorage()
+{
+  if (!isInline())
+    resource_->deallocate(data_, capacity_ * sizeof(T), alignof(T));
+
+  capacity_ = InlineCapacity;
+  data_ = this->inlineData();
 }
+
+#include "BitVector.h"
 #endif //VECTOR_H
@@ -0,0 +1,57 @@
+#ifndef BITKERNELS_H
+#define BITKERNELS_H
+#include <cstddef>
+#include <cstdint>
+
+// Hot bit-stream loops with per-CPU variants. The variant is picked once,
+// from the CPU features detected at startup (or the FANO_KERNELS
+// environment variable: scalar or avx2), and called through a function
+// pointer. Every variant produces bit-identical output.
+//
+// Only symbol encoding is dispatched, and its one accelerated variant is
+// AVX2; packing and unpacking bits always run the portable code in
+// BitVector.
+namespace bit_kernels
+{
+  enum class Isa
+  {
+    SCALAR,
+    AVX2
+  };
+
+  // Code words for every byte value, laid out as in Code: `bits` in stream
+  // order, zero above `lengths`. A length of 0 marks a byte with no code.
+  struct CodeTable
+  {
+    uint64_t bits[256];
+    uint8_t lengths[256];
+  };
+
+  // Writes the codes of `symbols` into `words` from bit `bitPosition` on,
+  // keeping the bits already below it, and advances `bitPosition`. Stops
+  // at the first symbol without a code and returns how many symbols were
+  // written. `words` must have room for count times the longest length
+  // in `codes` more bits.
+  using EncodeSymbols = size_t (*)(const uint8_t* symbols, size_t count,
+                                   const CodeTable& codes, uint64_t* words,
+                                   size_t& bitPosition);
+
+  struct Kernels
+  {
+    Isa isa;
+    EncodeSymbols encodeSymbols;
+  };
+
+  const char* name(Isa isa);
+
+  bool supported(Isa isa);
+
+  // The variant in use; the first call detects the CPU.
+  const Kernels& active();
+
+  // Switches to `isa` if the CPU supports it; used by tests and benches.
+  bool select(Isa isa);
+}
+
+
+#endif //BITKERNELS_H
@@ -18,6 +18,47 @@ namespace file_io
   void writeToFile(const String& outputFile, const Packed& packed);
 
   size_t getFileSize(const String& filePath);
+
+  // An output file whose final size is known before it is written. On
+  // Linux the bytes go to a new temporary file next to `path`, whose
+  // blocks are reserved up front with posix_fallocate; with `map` set,
+  // data() points into a shared mapping of it, so bytes written there need
+  // no further copy. commit() renames the temporary over `path`. Otherwise
+  // data() is a buffer that commit() writes out. Until commit() succeeds
+  // an existing file at `path` is left untouched.
+  class OutputFile
+  {
+  public:
+    OutputFile(const String& path, size_t size, bool map);
+
+    OutputFile(const OutputFile&) = delete;
+
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    ~OutputFile();
+
+    uint8_t* data();
+
+    size_t size() const;
+
+    bool mapped() const;
+
+    // Finishes the file; without it the destructor removes the temporary.
+    void commit();
+
+  private:
+    String path_;
+    String temporaryPath_;
+    size_t size_;
+    int descriptor_;
+    uint8_t* mapping_;
+    Buffer buffer_;
+    bool committed_;
+
+    void close();
+
+    void openTemporary();
+  };
 }
 
 
@@ -0,0 +1,83 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+#include <cstddef>
+#include <cstdint>
+
+// Layout constants shared by Encoder and Decoder.
+//
+// Stored layout, written when coding would not make the input smaller:
+//   [STORED_MARKER 1B][the input bytes]
+//
+// Legacy layout:
+//   [unused bits 1B][entries 1B][bitsPerCode 1B][table records][data]
+// as one LSB-first bit stream (see Decoder::openReader).
+//
+// Extended layout, written when an EncoderOptions feature needs it:
+//   [EXTENDED_MARKER 1B][flags 1B][streamCount 1B]
+//   [streamCount x 8B little-endian sub-stream bit lengths]
+//   if flags has FLAG_ORIGINAL_SIZE:
+//     [8B input length]
+//   if flags has FLAG_SYNC_INDEX:
+//     [sync interval 4B][sync point count 4B]
+//     [point count x streamCount x 8B bit offsets, point-major]
+//   [entries 1B][bitsPerCode 1B][table records, zero-padded to a byte]
+//   [sub-stream 0, zero-padded to a byte] ... [sub-stream N-1]
+// Symbol i of the input is coded in sub-stream i % streamCount.
+//
+// In both layouts an entries byte of 0 means all 256 byte values: a table
+// is never empty, so no earlier file uses it.
+//
+// Sync point k (from 1) sits k x interval symbols into every sub-stream,
+// i.e. at input symbol k x interval x streamCount, and holds each
+// sub-stream's bit offset there. Points are only written below the input
+// size, so the stretches between them decode independently into known
+// output ranges.
+namespace format
+{
+  // A legacy file starts with its unused trailing bit count (0..7), so
+  // these first bytes cannot be mistaken for one.
+  constexpr uint8_t EXTENDED_MARKER = 0xFA;
+  constexpr uint8_t STORED_MARKER = 0xFB;
+  constexpr size_t STORED_HEADER_SIZE = 1;
+
+  constexpr size_t LEGACY_HEADER_SIZE = 3;
+  // marker, flags and stream count
+  constexpr size_t EXTENDED_HEADER_SIZE = 3;
+  constexpr size_t STREAM_LENGTH_SIZE = 8;
+  constexpr size_t TABLE_HEADER_SIZE = 2;
+
+  constexpr uint8_t FLAG_SYNC_INDEX = 0x01;
+  constexpr uint8_t FLAG_ORIGINAL_SIZE = 0x02;
+  constexpr uint8_t KNOWN_FLAGS = FLAG_SYNC_INDEX | FLAG_ORIGINAL_SIZE;
+  constexpr size_t ORIGINAL_SIZE_SIZE = 8;
+  // interval and point count
+  constexpr size_t SYNC_HEADER_SIZE = 8;
+  constexpr size_t SYNC_FIELD_SIZE = 4;
+  constexpr size_t SYNC_OFFSET_SIZE = 8;
+
+  // Sub-stream counts with a decode kernel.
+  constexpr size_t MAX_STREAMS = 8;
+
+  inline bool isValidStreamCount(const size_t count)
+  {
+    return count == 1 || count == 2 || count == 4 || count == 8;
+  }
+
+  inline void storeLittleEndian(uint8_t* bytes, const uint64_t value,
+                                const size_t size)
+  {
+    for (size_t i = 0; i < size; i++)
+      bytes[i] = static_cast<uint8_t>(value >> i * 8);
+  }
+
+  inline uint64_t loadLittleEndian(const uint8_t* bytes, const size_t size)
+  {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+      value |= static_cast<uint64_t>(bytes[i]) << i * 8;
+    return value;
+  }
+}
+
+
+#endif //FORMAT_H
@@ -1,7 +1,11 @@
 #include "include/Decoder.h"
 #include "include/Encoder.h"
+#include "include/Profiler.h"
 #include "include/String.h"
 
+#include <cstdlib>
+#include <cstring>
+
 enum Mode
 {
   ENCODE,
@@ -9,8 +13,59 @@ enum Mode
   BOTH
 };
 
-int main()
+// --profile prints a phase table to stderr at exit, --profile=json the same
+// data as JSON; --counters adds hardware counters to either. --streams=N
+// encodes into N interleaved sub-streams, --sync-index[=N] adds sync points
+// every N symbols per sub-stream, and --threads=N decodes such files on N
+// threads (0: one per hardware thread); --speculative extends that to
+// files without sync points. --record-size stores the input length, which
+// lets the decoder preallocate its output and, with --mmap, write it
+// through a mapping. --no-stored codes input even where a stored copy
+// would be smaller.
+void parseOptions(const int argc, char* argv[], EncoderOptions& options,
+                  DecoderOptions& decoderOptions)
 {
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--profile") == 0)
+    {
+      Profiler::enable();
+      Profiler::reportAtExit(Profiler::Format::TABLE);
+    }
+    else if (std::strcmp(argv[i], "--profile=json") == 0)
+    {
+      Profiler::enable();
+      Profiler::reportAtExit(Profiler::Format::JSON);
+    }
+    else if (std::strcmp(argv[i], "--counters") == 0)
+      Profiler::enableCounters();
+    else if (std::strncmp(argv[i], "--streams=", 10) == 0)
+      options.streams = std::strtoull(argv[i] + 10, nullptr, 10);
+    else if (std::strcmp(argv[i], "--sync-index") == 0)
+      options.syncInterval = EncoderOptions::DEFAULT_SYNC_INTERVAL;
+    else if (std::strncmp(argv[i], "--sync-index=", 13) == 0)
+      options.syncInterval = std::strtoull(argv[i] + 13, nullptr, 10);
+    else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+      decoderOptions.threads = std::strtoull(argv[i] + 10, nullptr, 10);
+    else if (std::strcmp(argv[i], "--speculative") == 0)
+      decoderOptions.speculative = true;
+    else if (std::strcmp(argv[i], "--record-size") == 0)
+      options.recordSize = true;
+    else if (std::strcmp(argv[i], "--mmap") == 0)
+      decoderOptions.mapOutput = true;
+    else if (std::strcmp(argv[i], "--no-stored") == 0)
+      options.allowStored = false;
+    else
+      std::cerr << "Unknown option: " << argv[i] << "\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  EncoderOptions encoderOptions;
+  DecoderOptions decoderOptions;
+  parseOptions(argc, argv, encoderOptions, decoderOptions);
+
   String toEncodeFileName;
   String encodedFileName;
   String decodedFileName;
@@ -26,7 +81,7 @@ int main()
     std::cout << "Enter the path to the encoded file:";
     std::cin >> encodedFileName;
 
-    Encoder::encode(toEncodeFileName, encodedFileName);
+    Encoder::encode(toEncodeFileName, encodedFileName, encoderOptions);
   }
   else if (selectedMode == DECODE)
   {
@@ -35,7 +90,7 @@ int main()
     std::cout << "Enter the path to the result file:";
     std::cin >> decodedFileName;
 
-    Decoder::decode(encodedFileName, decodedFileName);
+    Decoder::decode(encodedFileName, decodedFileName, decoderOptions);
   }
   else if (selectedMode == BOTH)
   {
@@ -46,8 +101,8 @@ int main()
     std::cout << "Enter the path to the result file:";
     std::cin >> decodedFileName;
 
-    Encoder::encode(toEncodeFileName, encodedFileName);
-    Decoder::decode(encodedFileName, decodedFileName);
+    Encoder::encode(toEncodeFileName, encodedFileName, encoderOptions);
+    Decoder::decode(encodedFileName, decodedFileName, decoderOptions);
   }
   else
   {
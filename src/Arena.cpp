@@ -0,0 +1,140 @@
+#include "../include/Arena.h"
+
+#include <cstdint>
+#include <utility>
+
+Arena::Arena(const size_t chunkSize, MemoryResource* upstream) :
+  chunkSize_(chunkSize), upstream_(upstream), head_(nullptr),
+  cursor_(nullptr), end_(nullptr)
+{
+}
+
+Arena::Arena(const Arena& other) : Arena(other.chunkSize_, other.upstream_)
+{
+}
+
+Arena::Arena(Arena&& other) noexcept : Arena(other.chunkSize_,
+                                             other.upstream_)
+{
+  *this = std::move(other);
+}
+
+Arena& Arena::operator=(const Arena& other)
+{
+  if (this != &other)
+  {
+    release();
+    chunkSize_ = other.chunkSize_;
+    upstream_ = other.upstream_;
+  }
+  return *this;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept
+{
+  if (this != &other)
+  {
+    release();
+    chunkSize_ = other.chunkSize_;
+    upstream_ = other.upstream_;
+    head_ = other.head_;
+    cursor_ = other.cursor_;
+    end_ = other.end_;
+    other.head_ = nullptr;
+    other.cursor_ = nullptr;
+    other.end_ = nullptr;
+  }
+  return *this;
+}
+
+Arena::~Arena()
+{
+  release();
+}
+
+void* Arena::allocate(const size_t bytes, const size_t alignment)
+{
+  const uintptr_t address = reinterpret_cast<uintptr_t>(cursor_);
+  const uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+  const uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+  // the padding alone can run past the end of the chunk
+  if (head_ == nullptr || aligned > end ||
+    bytes > static_cast<size_t>(end - aligned))
+  {
+    addChunk(bytes + alignment);
+    return allocate(bytes, alignment);
+  }
+
+  cursor_ = reinterpret_cast<unsigned char*>(aligned + bytes);
+  return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::deallocate(void* pointer, const size_t bytes, size_t)
+{
+  if (static_cast<unsigned char*>(pointer) + bytes == cursor_)
+    cursor_ = static_cast<unsigned char*>(pointer);
+}
+
+void Arena::reset()
+{
+  if (head_ == nullptr)
+    return;
+
+  if (head_->next != nullptr)
+  {
+    const size_t total = capacity();
+    release();
+    addChunk(total);
+    return;
+  }
+
+  rewind();
+}
+
+void Arena::release()
+{
+  while (head_ != nullptr)
+  {
+    Chunk* next = head_->next;
+    upstream_->deallocate(head_, head_->size, alignof(Chunk));
+    head_ = next;
+  }
+  cursor_ = nullptr;
+  end_ = nullptr;
+}
+
+size_t Arena::capacity() const
+{
+  size_t total = 0;
+  for (const Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next)
+    total += chunk->size - sizeof(Chunk);
+  return total;
+}
+
+size_t Arena::chunkCount() const
+{
+  size_t count = 0;
+  for (const Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next)
+    count++;
+  return count;
+}
+
+void Arena::addChunk(const size_t minimumBytes)
+{
+  constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+  size_t payload = minimumBytes > chunkSize_ ? minimumBytes : chunkSize_;
+  payload = (payload + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  const size_t size = sizeof(Chunk) + payload;
+  Chunk* chunk = static_cast<Chunk*>(upstream_->allocate(size,
+                                                         alignof(Chunk)));
+  chunk->next = head_;
+  chunk->size = size;
+  head_ = chunk;
+  rewind();
+}
+
+void Arena::rewind()
+{
+  cursor_ = reinterpret_cast<unsigned char*>(head_ + 1);
+  end_ = reinterpret_cast<unsigned char*>(head_) + head_->size;
+}
@@ -0,0 +1,493 @@
+#include "../include/BitVector.h"
+
+#include <cstring>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define FANO_LITTLE_ENDIAN 1
+#else
+#define FANO_LITTLE_ENDIAN 0
+#endif
+
+constexpr size_t Vector<bool>::BITS_PER_WORD;
+
+Vector<bool>::Reference::Reference(uint64_t* word, const uint64_t mask) :
+  word_(word), mask_(mask)
+{
+}
+
+Vector<bool>::Reference::operator bool() const
+{
+  return (*word_ & mask_) != 0;
+}
+
+Vector<bool>::Reference& Vector<bool>::Reference::operator=(const bool value)
+{
+  if (value)
+    *word_ |= mask_;
+  else
+    *word_ &= ~mask_;
+  return *this;
+}
+
+Vector<bool>::Reference& Vector<bool>::Reference::operator=(
+  const Reference& other)
+{
+  return *this = static_cast<bool>(other);
+}
+
+Vector<bool>::Iterator::Iterator(const uint64_t* words, const size_t index) :
+  words_(words), index_(index)
+{
+}
+
+bool Vector<bool>::Iterator::operator*() const
+{
+  return words_[index_ / BITS_PER_WORD] >> index_ % BITS_PER_WORD & 1;
+}
+
+Vector<bool>::Iterator& Vector<bool>::Iterator::operator++()
+{
+  ++index_;
+  return *this;
+}
+
+Vector<bool>::Iterator Vector<bool>::Iterator::operator+(
+  const std::ptrdiff_t offset) const
+{
+  return {words_, index_ + offset};
+}
+
+Vector<bool>::Iterator Vector<bool>::Iterator::operator-(
+  const std::ptrdiff_t offset) const
+{
+  return {words_, index_ - offset};
+}
+
+std::ptrdiff_t Vector<bool>::Iterator::operator-(const Iterator& other) const
+{
+  return static_cast<std::ptrdiff_t>(index_) -
+    static_cast<std::ptrdiff_t>(other.index_);
+}
+
+bool Vector<bool>::Iterator::operator==(const Iterator& other) const
+{
+  return words_ == other.words_ && index_ == other.index_;
+}
+
+bool Vector<bool>::Iterator::operator!=(const Iterator& other) const
+{
+  return !(*this == other);
+}
+
+uint64_t Vector<bool>::Iterator::extract(const uint64_t* words,
+                                        const size_t index, const size_t count)
+{
+  if (count == 0)
+    return 0;
+
+  const size_t word = index / BITS_PER_WORD;
+  const size_t offset = index % BITS_PER_WORD;
+  uint64_t bits = words[word] >> offset;
+  if (offset + count > BITS_PER_WORD)
+    bits |= words[word + 1] << (BITS_PER_WORD - offset);
+
+  return bits & lowMask(count);
+}
+
+Vector<bool>::Vector() : capacity_(INLINE_CAPACITY), size_(0),
+                         words_(&inlineWord_), inlineWord_(0),
+                         resource_(MemoryResource::current())
+{
+}
+
+Vector<bool>::Vector(const size_t count, const bool value) : Vector()
+{
+  reserveBits(count);
+  for (size_t i = 0; i < wordsForBits(count); i++)
+    words_[i] = value ? ~static_cast<uint64_t>(0) : 0;
+  size_ = count;
+}
+
+Vector<bool>::Vector(const Iterator first, const Iterator last) : Vector()
+{
+  const size_t count = last - first;
+  reserveBits(count);
+  for (size_t copied = 0; copied < count; copied += BITS_PER_WORD)
+  {
+    const size_t chunk = std::min(BITS_PER_WORD, count - copied);
+    words_[copied / BITS_PER_WORD] =
+      Iterator::extract(first.words_, first.index_ + copied, chunk);
+  }
+  size_ = count;
+}
+
+Vector<bool>::Vector(const Vector& other) : Vector()
+{
+  *this = other;
+}
+
+Vector<bool>& Vector<bool>::operator=(const Vector& other)
+{
+  if (this != &other)
+  {
+    size_ = 0;
+    reserveBits(other.size_);
+    size_ = other.size_;
+    std::memcpy(words_, other.words_, wordCount() * sizeof(uint64_t));
+  }
+  return *this;
+}
+
+Vector<bool>::Vector(Vector&& other) noexcept : Vector()
+{
+  resource_ = other.resource_;
+  *this = std::move(other);
+}
+
+Vector<bool>& Vector<bool>::operator=(Vector&& other)
+{
+  if (this != &other)
+  {
+    if (other.resource_ != resource_ && !other.isInline())
+    {
+      // other's words belong to another resource, so copy them over
+      *this = static_cast<const Vector&>(other);
+      other.size_ = 0;
+      return *this;
+    }
+
+    releaseWords();
+    if (other.isInline())
+      inlineWord_ = other.inlineWord_;
+    else
+    {
+      capacity_ = other.capacity_;
+      words_ = other.words_;
+      other.resetToInline();
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+Vector<bool>::~Vector()
+{
+  releaseWords();
+}
+
+Vector<bool> Vector<bool>::fromBytes(const uint8_t* bytes,
+                                     const size_t byteCount)
+{
+  constexpr size_t BYTES_PER_WORD = sizeof(uint64_t);
+
+  Vector result;
+  result.reserveBits(byteCount * 8);
+#if FANO_LITTLE_ENDIAN
+  // the words' memory already is the LSB-first byte stream
+  if (byteCount)
+  {
+    result.words_[(byteCount - 1) / BYTES_PER_WORD] = 0;
+    std::memcpy(result.words_, bytes, byteCount);
+  }
+#else
+  for (size_t w = 0; w * BYTES_PER_WORD < byteCount; w++)
+  {
+    uint64_t word = 0;
+    const size_t base = w * BYTES_PER_WORD;
+    const size_t count = std::min(BYTES_PER_WORD, byteCount - base);
+    for (size_t i = 0; i < count; i++)
+      word |= static_cast<uint64_t>(bytes[base + i]) << i * 8;
+    result.words_[w] = word;
+  }
+#endif
+  result.size_ = byteCount * 8;
+  return result;
+}
+
+void Vector<bool>::toBytes(uint8_t* bytes) const
+{
+  const size_t byteCount = (size_ + 7) / 8;
+  if (byteCount == 0)
+    return;
+#if FANO_LITTLE_ENDIAN
+  std::memcpy(bytes, words_, byteCount);
+#else
+  for (size_t i = 0; i < byteCount; i++)
+    bytes[i] = static_cast<uint8_t>(words_[i / 8] >> i % 8 * 8);
+#endif
+
+  if (size_ % 8)
+    bytes[byteCount - 1] &= static_cast<uint8_t>(lowMask(size_ % 8));
+}
+
+void Vector<bool>::pushBack(const bool value)
+{
+  appendBits(value, 1);
+}
+
+void Vector<bool>::popBack()
+{
+  if (size_ > 0)
+    size_--;
+}
+
+void Vector<bool>::appendBits(uint64_t bits, const size_t count)
+{
+  if (count == 0)
+    return;
+
+  reserveBits(size_ + count);
+  bits &= lowMask(count);
+
+  const size_t word = size_ / BITS_PER_WORD;
+  const size_t offset = size_ % BITS_PER_WORD;
+  if (offset == 0)
+    words_[word] = bits;
+  else
+  {
+    words_[word] = (words_[word] & lowMask(offset)) | bits << offset;
+    if (offset + count > BITS_PER_WORD)
+      words_[word + 1] = bits >> (BITS_PER_WORD - offset);
+  }
+  size_ += count;
+}
+
+size_t Vector<bool>::appendCodes(const uint8_t* symbols, const size_t count,
+                                 const bit_kernels::CodeTable& codes)
+{
+  // bounds how far ahead of size_ the kernel may write
+  constexpr size_t BLOCK_SIZE = size_t{1} << 16;
+
+  size_t maxLength = 0;
+  for (const uint8_t length : codes.lengths)
+    maxLength = std::max(maxLength, static_cast<size_t>(length));
+
+  const bit_kernels::EncodeSymbols encodeSymbols =
+    bit_kernels::active().encodeSymbols;
+  size_t done = 0;
+  while (done < count)
+  {
+    const size_t block = std::min(BLOCK_SIZE, count - done);
+    reserveBits(size_ + block * maxLength);
+    const size_t encoded = encodeSymbols(symbols + done, block, codes, words_,
+                                         size_);
+    done += encoded;
+    if (encoded < block)
+      break;
+  }
+  return done;
+}
+
+uint64_t Vector<bool>::getBits(const size_t index, const size_t count) const
+{
+#ifdef FANO_CHECKED_ACCESS
+  if (count > BITS_PER_WORD || index + count > size_)
+    throw std::out_of_range("Index out of range");
+#endif
+
+  return Iterator::extract(words_, index, count);
+}
+
+Vector<bool>::Reference Vector<bool>::operator[](const size_t index)
+{
+#ifdef FANO_CHECKED_ACCESS
+  return at(index);
+#else
+  return {
+    words_ + index / BITS_PER_WORD,
+    static_cast<uint64_t>(1) << index % BITS_PER_WORD
+  };
+#endif
+}
+
+bool Vector<bool>::operator[](const size_t index) const
+{
+#ifdef FANO_CHECKED_ACCESS
+  return at(index);
+#else
+  return words_[index / BITS_PER_WORD] >> index % BITS_PER_WORD & 1;
+#endif
+}
+
+Vector<bool>::Reference Vector<bool>::at(const size_t index)
+{
+  if (index >= size_)
+    throw std::out_of_range("Index out of range");
+
+  return {
+    words_ + index / BITS_PER_WORD,
+    static_cast<uint64_t>(1) << index % BITS_PER_WORD
+  };
+}
+
+bool Vector<bool>::at(const size_t index) const
+{
+  if (index >= size_)
+    throw std::out_of_range("Index out of range");
+
+  return words_[index / BITS_PER_WORD] >> index % BITS_PER_WORD & 1;
+}
+
+Vector<bool>& Vector<bool>::operator+=(const Vector& other)
+{
+  if (this == &other)
+    return *this += Vector(other);
+
+  reserveBits(size_ + other.size_);
+  const size_t fullWords = other.size_ / BITS_PER_WORD;
+  for (size_t i = 0; i < fullWords; i++)
+    appendBits(other.words_[i], BITS_PER_WORD);
+  if (other.size_ % BITS_PER_WORD)
+    appendBits(other.words_[fullWords], other.size_ % BITS_PER_WORD);
+
+  return *this;
+}
+
+size_t Vector<bool>::size() const
+{
+  return size_;
+}
+
+bool Vector<bool>::empty() const
+{
+  return size_ == 0;
+}
+
+void Vector<bool>::clear()
+{
+  size_ = 0;
+}
+
+size_t Vector<bool>::hash() const
+{
+  // FNV-1a over whole words, with the bit length folded in so that codes
+  // differing only in trailing zeros hash differently
+  size_t hash = 0xcbf29ce484222325;
+  const size_t count = wordCount();
+  for (size_t i = 0; i < count; i++)
+  {
+    hash ^= i + 1 == count ? lastWordMasked() : words_[i];
+    hash *= 0x100000001b3;
+  }
+  hash ^= size_;
+  hash *= 0x100000001b3;
+  return hash;
+}
+
+const uint64_t* Vector<bool>::words() const
+{
+  return words_;
+}
+
+size_t Vector<bool>::wordCount() const
+{
+  return wordsForBits(size_);
+}
+
+bool Vector<bool>::isInline() const
+{
+  return words_ == &inlineWord_;
+}
+
+MemoryResource* Vector<bool>::resource() const
+{
+  return resource_;
+}
+
+Vector<bool>::Iterator Vector<bool>::begin() const
+{
+  return {words_, 0};
+}
+
+Vector<bool>::Iterator Vector<bool>::end() const
+{
+  return {words_, size_};
+}
+
+std::ostream& operator<<(std::ostream& os, const Vector<bool>& vec)
+{
+  os << "[";
+  for (size_t i = 0; i < vec.size_; ++i)
+  {
+    os << vec[i];
+    if (i < vec.size_ - 1)
+      os << ", ";
+  }
+  os << "]";
+  return os;
+}
+
+bool operator==(const Vector<bool>& lhs, const Vector<bool>& rhs)
+{
+  if (lhs.size_ != rhs.size_)
+    return false;
+
+  const size_t count = lhs.wordCount();
+  if (count == 0)
+    return true;
+
+  for (size_t i = 0; i + 1 < count; i++)
+    if (lhs.words_[i] != rhs.words_[i])
+      return false;
+
+  return lhs.lastWordMasked() == rhs.lastWordMasked();
+}
+
+bool operator!=(const Vector<bool>& lhs, const Vector<bool>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+size_t Vector<bool>::wordsForBits(const size_t bits)
+{
+  return (bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+uint64_t Vector<bool>::lowMask(const size_t count)
+{
+  return count >= BITS_PER_WORD
+           ? ~static_cast<uint64_t>(0)
+           : (static_cast<uint64_t>(1) << count) - 1;
+}
+
+void Vector<bool>::reserveBits(const size_t bits)
+{
+  const size_t needed = wordsForBits(bits);
+  if (needed <= capacity_)
+    return;
+
+  size_t newCapacity = capacity_ * 2;
+  if (newCapacity < needed)
+    newCapacity = needed;
+
+  uint64_t* newWords = static_cast<uint64_t*>(
+    resource_->allocate(newCapacity * sizeof(uint64_t), alignof(uint64_t)));
+  if (size_)
+    std::memcpy(newWords, words_, wordCount() * sizeof(uint64_t));
+
+  releaseWords();
+  words_ = newWords;
+  capacity_ = newCapacity;
+}
+
+void Vector<bool>::releaseWords()
+{
+  if (!isInline())
+    resource_->deallocate(words_, capacity_ * sizeof(uint64_t),
+                          alignof(uint64_t));
+  resetToInline();
+}
+
+void Vector<bool>::resetToInline()
+{
+  capacity_ = INLINE_CAPACITY;
+  words_ = &inlineWord_;
+}
+
+uint64_t Vector<bool>::lastWordMasked() const
+{
+  const size_t count = wordCount();
+  const size_t tail = size_ % BITS_PER_WORD;
+  return tail ? words_[count - 1] & lowMask(tail) : words_[count - 1];
+}
@@ -1,19 +1,22 @@
 #include "../include/ByteEntry.h"
 
+#include <utility>
+
 ByteEntry::ByteEntry() : byte(0), occurrences(0)
 {
 }
 
-ByteEntry::ByteEntry(const uint8_t byte, const int occurrences) : byte(byte),
+ByteEntry::ByteEntry(const uint8_t byte, const uint64_t occurrences) :
+  byte(byte),
   occurrences(occurrences)
 {
 }
 
 void ByteEntry::swap(ByteEntry& a, ByteEntry& b) noexcept
 {
-  const ByteEntry temp = a;
-  a = b;
-  b = temp;
+  ByteEntry temp = std::move(a);
+  a = std::move(b);
+  b = std::move(temp);
 }
 
 std::ostream& operator<<(std::ostream& os, const ByteEntry& obj)
@@ -21,7 +24,7 @@ std::ostream& operator<<(std::ostream& os, const ByteEntry& obj)
   os <<
     "{symbol: 0x" << std::hex << std::uppercase << static_cast<int>(obj.byte) <<
     " freq: " << std::dec << obj.occurrences <<
-    " code: " << std::noboolalpha << obj.code << std::boolalpha <<
+    " code: " << obj.code <<
     "}";
 
   return os;
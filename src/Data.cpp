@@ -1,5 +1,8 @@
 #include "../include/Data.h"
 
+#include "../include/bit_utils.h"
+#include "../include/DataReader.h"
+
 Data::Data(const Buffer& buffer) : data_(buffer)
 {
   if (buffer.empty())
@@ -14,36 +17,109 @@ Data::Data(Data&&) noexcept = default;
 
 Data& Data::operator=(const Data&) = default;
 
-Data& Data::operator=(Data&&) noexcept = default;
+Data& Data::operator=(Data&&) = default;
 
 Data::~Data() = default;
 
 Encoded Data::encode(const Table& table)
 {
+  return encode(table, data_.data(), data_.size());
+}
+
+namespace
+{
+  bit_kernels::CodeTable codeTableFor(const Table& table)
+  {
+    bit_kernels::CodeTable codes = {};
+    for (const Pair<const uint8_t&, const ByteEntry&> pair :
+         table.getRawTable())
+    {
+      codes.bits[pair.first] = pair.second.code.bits;
+      codes.lengths[pair.first] = pair.second.code.length;
+    }
+    return codes;
+  }
+}
+
+Encoded Data::encode(const Table& table, const uint8_t* bytes,
+                     const size_t size)
+{
+  const bit_kernels::CodeTable codes = codeTableFor(table);
+
   Encoded encodedData;
-  for (const uint8_t byte : data_)
-    encodedData += table.getCodeForByte(byte);
+  if (encodedData.appendCodes(bytes, size, codes) != size)
+    throw DataException("Byte missing from code table");
 
   return encodedData;
 }
 
-void Data::decode(const Table& table, const Encoded& encodedData)
+Vector<Encoded> Data::encodeStreams(const Table& table, const uint8_t* bytes,
+                                    const size_t size,
+                                    const size_t streamCount,
+                                    const size_t syncInterval,
+                                    Vector<uint64_t>* syncOffsets)
 {
-  data_.clear();
-  Encoded currentCode;
-  uint8_t byte;
-  for (bool bit : encodedData)
-  {
-    currentCode.pushBack(bit);
+  constexpr size_t GATHER_SIZE = 4096;
 
-    if (table.getByteByCode(currentCode, byte))
+  if (streamCount == 0)
+    throw DataException("Stream count must be positive");
+  if (syncInterval != 0 && syncOffsets == nullptr)
+    throw DataException("Sync offsets output is null");
+
+  // points at input symbols k * syncInterval * streamCount below size
+  const size_t pointCount = syncInterval == 0 || size == 0
+                              ? 0
+                              : (size - 1) / syncInterval / streamCount;
+  if (syncOffsets)
+    *syncOffsets = Vector<uint64_t>(pointCount * streamCount, 0);
+
+  const bit_kernels::CodeTable codes = codeTableFor(table);
+  Vector<Encoded> streams;
+  uint8_t gathered[GATHER_SIZE];
+  for (size_t stream = 0; stream < streamCount; stream++)
+  {
+    Encoded& encoded = streams.emplaceBack();
+    size_t next = stream;
+    size_t coded = 0;
+    size_t point = 0;
+    while (next < size)
     {
-      data_.pushBack(byte);
-      currentCode.clear();
+      // a gather never crosses a sync point
+      size_t limit = GATHER_SIZE;
+      if (point < pointCount)
+        limit = std::min(limit, (point + 1) * syncInterval - coded);
+
+      size_t count = 0;
+      for (; count < limit && next < size; count++, next += streamCount)
+        gathered[count] = bytes[next];
+      if (encoded.appendCodes(gathered, count, codes) != count)
+        throw DataException("Byte missing from code table");
+
+      coded += count;
+      if (point < pointCount && coded == (point + 1) * syncInterval)
+        (*syncOffsets)[point++ * streamCount + stream] = encoded.size();
     }
   }
-  if (!currentCode.empty())
-    throw DataException("Leftover bits in buffer");
+
+  return streams;
+}
+
+void Data::decode(const Table& table, const Encoded& encodedData)
+{
+  constexpr size_t CHUNK_SIZE = 4096;
+
+  const Packed packed = bit_utils::packBits(encodedData);
+  DataReader reader(table, packed.data(), 0, encodedData.size());
+  data_.clear();
+  size_t produced;
+  do
+  {
+    const size_t offset = data_.size();
+    data_.resizeUninitialized(offset + CHUNK_SIZE);
+    produced = reader.read(data_.data() + offset, CHUNK_SIZE);
+    data_.resizeUninitialized(offset + produced);
+  }
+  while (produced != 0);
 }
 
 const Vector<uint8_t>& Data::getData() const
@@ -0,0 +1,353 @@
+#include "../include/DataReader.h"
+
+#include <cstring>
+
+namespace
+{
+  // Longest code with a compiled kernel; longer ones use decodeOne().
+  constexpr unsigned MAX_KERNEL_WIDTH = 16;
+
+  uint64_t lowMask(const size_t count)
+  {
+    return count >= 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+  }
+
+  uint64_t loadLittleEndian(const uint8_t* bytes)
+  {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+#else
+    uint64_t word = 0;
+    for (size_t i = 0; i < sizeof(word); i++)
+      word |= static_cast<uint64_t>(bytes[i]) << i * 8;
+    return word;
+#endif
+  }
+
+  // Smallest kernel width that holds every code of `maxLength` bits.
+  unsigned widthFor(const size_t maxLength)
+  {
+    if (maxLength <= 8)
+      return 8;
+    if (maxLength <= 11)
+      return 11;
+    if (maxLength <= 12)
+      return 12;
+    if (maxLength <= 15)
+      return 15;
+    return MAX_KERNEL_WIDTH;
+  }
+}
+
+DataReader::DataReader(const Table& table, const uint8_t* bytes,
+                       const size_t bitOffset, const size_t bitCount) :
+  cursors_(), streamCount_(0), nextStream_(0), width_(8), kernel_(nullptr)
+{
+  const BitStream stream = {bytes, bitOffset, bitCount};
+  openStreams(&stream, 1);
+  buildLookup(table);
+}
+
+DataReader::DataReader(const Table& table, const BitStream* streams,
+                       const size_t streamCount) :
+  cursors_(), streamCount_(0), nextStream_(0), width_(8), kernel_(nullptr)
+{
+  openStreams(streams, streamCount);
+  buildLookup(table);
+}
+
+DataReader::DataReader(const uint8_t* bytes, const size_t size) :
+  cursors_(), streamCount_(0), nextStream_(0), width_(8),
+  kernel_(&DataReader::readStored)
+{
+  const BitStream stream = {bytes, 0, size * 8};
+  openStreams(&stream, 1);
+}
+
+DataReader::DataReader(const DataReader&) = default;
+
+DataReader::DataReader(DataReader&&) noexcept = default;
+
+DataReader& DataReader::operator=(const DataReader&) = default;
+
+DataReader& DataReader::operator=(DataReader&&) = default;
+
+DataReader::~DataReader() = default;
+
+void DataReader::restart(const BitStream* streams, const size_t streamCount)
+{
+  // the kernel was picked for the current count
+  if (streamCount != streamCount_)
+    throw DataException("Stream count does not match");
+
+  openStreams(streams, streamCount);
+  nextStream_ = 0;
+}
+
+size_t DataReader::read(uint8_t* output, const size_t capacity)
+{
+  return (this->*kernel_)(output, capacity);
+}
+
+bool DataReader::atEnd() const
+{
+  for (size_t i = 0; i < streamCount_; i++)
+    if (cursors_[i].position != cursors_[i].end)
+      return false;
+  return true;
+}
+
+unsigned DataReader::width() const
+{
+  return width_;
+}
+
+size_t DataReader::position() const
+{
+  return cursors_[0].position;
+}
+
+void DataReader::openStreams(const BitStream* streams,
+                             const size_t streamCount)
+{
+  if (!format::isValidStreamCount(streamCount))
+    throw DataException("Unsupported stream count");
+
+  for (size_t i = 0; i < streamCount; i++)
+  {
+    const BitStream& stream = streams[i];
+    if (stream.bytes == nullptr && stream.bitCount != 0)
+      throw DataException("Input is null");
+
+    Cursor& cursor = cursors_[i];
+    cursor.bytes = stream.bytes;
+    cursor.position = stream.bitOffset;
+    cursor.end = stream.bitOffset + stream.bitCount;
+    cursor.byteEnd = (cursor.end + 7) / 8;
+  }
+  streamCount_ = streamCount;
+}
+
+void DataReader::buildLookup(const Table& table)
+{
+  size_t maxLength = 0;
+  for (const Pair<const uint8_t&, const ByteEntry&> pair : table.getRawTable())
+    maxLength = std::max(maxLength,
+                         static_cast<size_t>(pair.second.code.length));
+
+  width_ = widthFor(maxLength);
+  switch (width_)
+  {
+  case 8:
+    selectKernel<8>();
+    break;
+  case 11:
+    selectKernel<11>();
+    break;
+  case 12:
+    selectKernel<12>();
+    break;
+  case 15:
+    selectKernel<15>();
+    break;
+  default:
+    selectKernel<MAX_KERNEL_WIDTH>();
+    break;
+  }
+
+  lookup_ = Vector<uint16_t>(size_t{1} << width_, 0);
+  // Longest codes first, so if a damaged table holds a code that prefixes
+  // another, the shorter one wins as it would reading bit by bit.
+  for (size_t length = maxLength; length > 0; length--)
+    for (const Pair<const uint8_t&, const ByteEntry&> pair :
+         table.getRawTable())
+    {
+      const Code& code = pair.second.code;
+      if (code.length != length)
+        continue;
+      if (length > width_)
+      {
+        longCodes_.insert(0, &code, 1);
+        longBytes_.insert(0, &pair.first, 1);
+        continue;
+      }
+
+      const uint16_t entry = static_cast<uint16_t>(length << 8 | pair.first);
+      for (size_t high = 0; high < size_t{1} << (width_ - length); high++)
+        lookup_[code.bits | high << length] = entry;
+    }
+}
+
+template <unsigned Width>
+void DataReader::selectKernel()
+{
+  switch (streamCount_)
+  {
+  case 2:
+    kernel_ = &DataReader::readWithWidth<Width, 2>;
+    break;
+  case 4:
+    kernel_ = &DataReader::readWithWidth<Width, 4>;
+    break;
+  case 8:
+    kernel_ = &DataReader::readWithWidth<Width, 8>;
+    break;
+  default:
+    kernel_ = &DataReader::readWithWidth<Width, 1>;
+    break;
+  }
+}
+
+template <unsigned Width, unsigned Streams>
+size_t DataReader::readWithWidth(uint8_t* output, const size_t capacity)
+{
+  // A refill shifts out at most 7 bits of a 64-bit load, so at least 57
+  // bits are valid: enough for this many codes of Width bits.
+  constexpr unsigned CODES_PER_REFILL = 57 / Width;
+  constexpr uint64_t MASK = (uint64_t{1} << Width) - 1;
+  constexpr size_t BLOCK_BITS = CODES_PER_REFILL * Width;
+  constexpr size_t BLOCK_SYMBOLS = CODES_PER_REFILL * Streams;
+
+  // A block may start in a sub-stream below its fastEnd: the load stays
+  // inside the stream and every code of the block ends before its end.
+  size_t fastEnd[Streams];
+  for (unsigned s = 0; s < Streams; s++)
+  {
+    const Cursor& cursor = cursors_[s];
+    fastEnd[s] = 0;
+    if (cursor.byteEnd >= 8 && cursor.end >= BLOCK_BITS)
+      fastEnd[s] = std::min((cursor.byteEnd - 7) * 8,
+                            cursor.end - BLOCK_BITS + 1);
+  }
+
+  const uint16_t* lookup = lookup_.data();
+  size_t produced = 0;
+  while (produced < capacity)
+  {
+    bool fast = nextStream_ == 0 && capacity - produced >= BLOCK_SYMBOLS;
+    for (unsigned s = 0; s < Streams; s++)
+      fast = fast && cursors_[s].position < fastEnd[s];
+
+    if (fast)
+    {
+      size_t position[Streams];
+      uint64_t window[Streams];
+      for (unsigned s = 0; s < Streams; s++)
+      {
+        position[s] = cursors_[s].position;
+        window[s] = loadLittleEndian(cursors_[s].bytes + (position[s] >> 3))
+          >> (position[s] & 7);
+      }
+
+      bool stalled = false;
+      for (unsigned code = 0; code < CODES_PER_REFILL && !stalled; code++)
+        for (unsigned s = 0; s < Streams; s++)
+        {
+          const uint16_t entry = lookup[window[s] & MASK];
+          if (entry == 0)
+          {
+            // finish this round from sub-stream s on the slow path
+            nextStream_ = s;
+            stalled = true;
+            break;
+          }
+          const unsigned length = entry >> 8;
+          output[produced++] = static_cast<uint8_t>(entry);
+          window[s] >>= length;
+          position[s] += length;
+        }
+
+      for (unsigned s = 0; s < Streams; s++)
+        cursors_[s].position = position[s];
+      if (!stalled)
+        continue;
+    }
+
+    // stream tails, long codes and bad input
+    Cursor& cursor = cursors_[nextStream_];
+    if (cursor.position == cursor.end)
+    {
+      checkAllStreamsEnded();
+      break;
+    }
+    decodeOne(cursor, output[produced++]);
+    nextStream_ = (nextStream_ + 1) % Streams;
+  }
+
+  return produced;
+}
+
+size_t DataReader::readStored(uint8_t* output, const size_t capacity)
+{
+  Cursor& cursor = cursors_[0];
+  const size_t count = std::min(capacity, (cursor.end - cursor.position) / 8);
+  if (count != 0)
+    std::memcpy(output, cursor.bytes + cursor.position / 8, count);
+  cursor.position += count * 8;
+  return count;
+}
+
+uint64_t DataReader::peek(const Cursor& cursor, const size_t position)
+{
+  const size_t first = position >> 3;
+  const unsigned shift = position & 7;
+
+  uint64_t bits;
+  if (first + 8 <= cursor.byteEnd)
+    bits = loadLittleEndian(cursor.bytes + first);
+  else
+  {
+    bits = 0;
+    for (size_t i = 0; first + i < cursor.byteEnd; i++)
+      bits |= static_cast<uint64_t>(cursor.bytes[first + i]) << i * 8;
+  }
+
+  bits >>= shift;
+  if (shift && first + 8 < cursor.byteEnd)
+    bits |= static_cast<uint64_t>(cursor.bytes[first + 8]) << (64 - shift);
+  return bits;
+}
+
+void DataReader::decodeOne(Cursor& cursor, uint8_t& byte) const
+{
+  const size_t remaining = cursor.end - cursor.position;
+  const uint64_t window = peek(cursor, cursor.position);
+
+  // Bits past the end are garbage, but a prefix code decides on its own
+  // bits: a match longer than what is left means the stream ends mid-code.
+  const uint16_t entry = lookup_[window & lowMask(width_)];
+  if (entry != 0)
+  {
+    if ((entry >> 8) > remaining)
+      throw DataException("Leftover bits in buffer");
+    byte = static_cast<uint8_t>(entry);
+    cursor.position += entry >> 8;
+    return;
+  }
+
+  for (size_t i = 0; i < longCodes_.size(); i++)
+  {
+    const Code& code = longCodes_[i];
+    if (code.length <= remaining && (window & lowMask(code.length)) ==
+      code.bits)
+    {
+      byte = longBytes_[i];
+      cursor.position += code.length;
+      return;
+    }
+  }
+
+  // no code can start here; report it the way a bit-by-bit reader would
+  if (remaining > Code::MAX_LENGTH)
+    throw DataException("Unknown code in buffer");
+  throw DataException("Leftover bits in buffer");
+}
+
+void DataReader::checkAllStreamsEnded() const
+{
+  for (size_t i = 0; i < streamCount_; i++)
+    if (cursors_[i].position != cursors_[i].end)
+      throw DataException("Sub-stream lengths do not match");
+}
@@ -1,5 +1,10 @@
 #include "../include/Decoder.h"
 
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+
 Decoder::Decoder() = default;
 
 Decoder::Decoder(const Decoder&) = default;
@@ -12,7 +17,250 @@ Decoder& Decoder::operator=(Decoder&&) noexcept = default;
 
 Decoder::~Decoder() = default;
 
-void Decoder::decode(const String& inputFilePath, const String& outputFilePath)
+void Decoder::decode(const String& inputFilePath, const String& outputFilePath,
+                     const DecoderOptions& options)
+{
+  ScopedTimer scopedTimer("Decoder");
+  try
+  {
+    file_io::checkFiles(inputFilePath, outputFilePath);
+    Buffer rawBuffer;
+    {
+      ProfileScope phase("read");
+      rawBuffer = file_io::readFileToBuffer(inputFilePath);
+      phase.addBytes(rawBuffer.size());
+    }
+
+    Buffer decoded;
+    if (isStored(rawBuffer.data(), rawBuffer.size()))
+    {
+      const size_t size = rawBuffer.size() - format::STORED_HEADER_SIZE;
+      file_io::OutputFile output(outputFilePath, size, options.mapOutput);
+      decode(rawBuffer.data(), rawBuffer.size(), output.data(), size,
+             options);
+
+      ProfileScope phase("write", size);
+      output.commit();
+      return;
+    }
+
+    if (isExtended(rawBuffer.data(), rawBuffer.size()))
+    {
+      // parsed once; the layout sizes the output and then decodes into it
+      ExtendedLayout layout;
+      parseExtended(rawBuffer.data(), rawBuffer.size(), layout);
+      if (layout.hasOriginalSize)
+      {
+        file_io::OutputFile output(outputFilePath, layout.originalSize,
+                                   options.mapOutput);
+        decodeExtended(layout, threadCount(options), output.data());
+
+        ProfileScope phase("write", layout.originalSize);
+        output.commit();
+        return;
+      }
+      decode(layout, decoded, options);
+    }
+    else
+      decode(rawBuffer.data(), rawBuffer.size(), decoded, options);
+
+    {
+      ProfileScope phase("write", decoded.size());
+      file_io::writeToFile(outputFilePath, decoded);
+    }
+  }
+  catch (const std::exception& ex)
+  {
+    scopedTimer.suppress();
+    std::cerr << ex.what() << "\n";
+  }
+}
+
+void Decoder::decode(const uint8_t* input, const size_t inputSize,
+                     Buffer& output, const DecoderOptions& options)
+{
+  const size_t threads = threadCount(options);
+  output.clear();
+
+  if (isStored(input, inputSize))
+  {
+    ProfileScope phase("decode data", inputSize - format::STORED_HEADER_SIZE);
+    output.append(input + format::STORED_HEADER_SIZE,
+                  inputSize - format::STORED_HEADER_SIZE);
+    return;
+  }
+
+  if (isExtended(input, inputSize))
+  {
+    ExtendedLayout layout;
+    parseExtended(input, inputSize, layout);
+    decode(layout, output, options);
+    return;
+  }
+
+  if (threads > 1 && options.speculative)
+  {
+    Table table;
+    BitStream data;
+    parseLegacy(input, inputSize, table, data);
+    decodeSpeculatively(table, data, threads, output);
+    return;
+  }
+
+  DataReader reader = openReader(input, inputSize);
+
+  ProfileScope phase("decode data");
+  readAll(reader, output);
+  phase.addBytes(output.size());
+}
+
+void Decoder::decode(const uint8_t* input, const size_t inputSize,
+                     uint8_t* output, const size_t outputSize,
+                     const DecoderOptions& options)
+{
+  if (isStored(input, inputSize))
+  {
+    const size_t size = inputSize - format::STORED_HEADER_SIZE;
+    if (outputSize != size)
+      throw DecoderException("Output size does not match the original size");
+    if (output == nullptr && outputSize != 0)
+      throw DecoderException("Output is null");
+
+    ProfileScope phase("decode data", size);
+    if (size != 0)
+      std::memcpy(output, input + format::STORED_HEADER_SIZE, size);
+    return;
+  }
+
+  if (!isExtended(input, inputSize))
+    throw DecoderException("Input does not record its original size");
+
+  ExtendedLayout layout;
+  parseExtended(input, inputSize, layout);
+  if (!layout.hasOriginalSize)
+    throw DecoderException("Input does not record its original size");
+  if (outputSize != layout.originalSize)
+    throw DecoderException("Output size does not match the original size");
+  if (output == nullptr && outputSize != 0)
+    throw DecoderException("Output is null");
+
+  decodeExtended(layout, threadCount(options), output);
+}
+
+bool Decoder::originalSize(const uint8_t* input, const size_t inputSize,
+                           size_t& size)
+{
+  if (isStored(input, inputSize))
+  {
+    size = inputSize - format::STORED_HEADER_SIZE;
+    return true;
+  }
+
+  if (!isExtended(input, inputSize))
+    return false;
+
+  uint8_t flags;
+  ExtendedLayout layout;
+  parseExtendedHeader(input, inputSize, flags, layout);
+  size = layout.originalSize;
+  return layout.hasOriginalSize;
+}
+
+void Decoder::decode(const ExtendedLayout& layout, Buffer& output,
+                     const DecoderOptions& options)
+{
+  const size_t threads = threadCount(options);
+  output.clear();
+
+  if (layout.hasOriginalSize)
+  {
+    output.resizeUninitialized(layout.originalSize);
+    decodeExtended(layout, threads, output.data());
+    return;
+  }
+
+  if (threads > 1 && layout.syncPointCount != 0)
+  {
+    ProfileScope phase("decode data");
+    output.resizeUninitialized(layout.syncedSize);
+    Buffer tail;
+    decodeSyncChunks(layout, threads, output.data(), &tail);
+    output.append(tail.data(), tail.size());
+    phase.addBytes(output.size());
+    return;
+  }
+
+  DataReader reader(layout.table, layout.streams, layout.streamCount);
+  ProfileScope phase("decode data");
+  readAll(reader, output);
+  phase.addBytes(output.size());
+}
+
+size_t Decoder::threadCount(const DecoderOptions& options)
+{
+  if (options.threads != 0)
+    return options.threads;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Decoder::decodeExtended(const ExtendedLayout& layout,
+                             const size_t threads, uint8_t* output)
+{
+  ProfileScope phase("decode data", layout.originalSize);
+  if (threads > 1 && layout.syncPointCount != 0)
+  {
+    decodeSyncChunks(layout, threads, output, nullptr);
+    return;
+  }
+
+  DataReader reader(layout.table, layout.streams, layout.streamCount);
+  readExactly(reader, output, layout.originalSize);
+}
+
+void Decoder::readExactly(DataReader& reader, uint8_t* output,
+                          const size_t size)
+{
+  // read() stops short only where the data ends
+  if (reader.read(output, size) != size || !reader.atEnd())
+    throw DecoderException("Original size does not match the data");
+}
+
+void Decoder::readAll(DataReader& reader, Buffer& output)
+{
+  constexpr size_t CHUNK_SIZE = 4096;
+
+  size_t produced;
+  do
+  {
+    const size_t offset = output.size();
+    output.resizeUninitialized(offset + CHUNK_SIZE);
+    produced = reader.read(output.data() + offset, CHUNK_SIZE);
+    output.resizeUninitialized(offset + produced);
+  }
+  while (produced != 0);
+}
+
+DataReader Decoder::openReader(const uint8_t* input, const size_t inputSize)
+{
+  if (isStored(input, inputSize))
+    return DataReader(input + format::STORED_HEADER_SIZE,
+                      inputSize - format::STORED_HEADER_SIZE);
+
+  if (isExtended(input, inputSize))
+  {
+    ExtendedLayout layout;
+    parseExtended(input, inputSize, layout);
+    return DataReader(layout.table, layout.streams, layout.streamCount);
+  }
+
+  Table table;
+  BitStream data;
+  parseLegacy(input, inputSize, table, data);
+  return DataReader(table, &data, 1);
+}
+
+void Decoder::parseLegacy(const uint8_t* input, const size_t inputSize,
+                          Table& table, BitStream& data)
 {
   /*
       ===== BINARY FILE DATA STORAGE SCHEME =====
@@ -28,6 +276,7 @@ void Decoder::decode(const String& inputFilePath, const String& outputFilePath)
        of       unique        code (with
        unused   symbols       leading 1
        bits     in table      included)
+                (0 for 256)
 
       Then comes the encoding table block:
       Repeated numOfEntries times:
@@ -46,55 +295,449 @@ void Decoder::decode(const String& inputFilePath, const String& outputFilePath)
           (trailing unused bits are ignored)
 
       All data after the first 3 bytes is treated as a bit stream.
+
+      A first byte of format::EXTENDED_MARKER selects the extended layout
+      described in format.h instead, and format::STORED_MARKER a stored
+      copy of the input.
       */
 
-  ScopedTimer scopedTimer("Decoder");
-  try
+  ProfileScope phase("decode table");
+
+  constexpr size_t HEADER_SIZE = format::LEGACY_HEADER_SIZE;
+  constexpr size_t INDEX_UNUSED_BITS_QUANTITY = 0;
+  constexpr size_t INDEX_NUM_OF_ENTRIES = 1;
+  constexpr size_t INDEX_BITS_PER_CODE = 2;
+
+  if (input == nullptr || inputSize < HEADER_SIZE)
+    throw DecoderException("Incorrect header format");
+
+  const uint8_t unusedBitsQuantity = input[INDEX_UNUSED_BITS_QUANTITY];
+  const uint8_t numberOfEntries = input[INDEX_NUM_OF_ENTRIES];
+  const uint8_t bitsPerCode = input[INDEX_BITS_PER_CODE];
+
+  const size_t streamBitSize = (inputSize - HEADER_SIZE) *
+    bit_utils::BITS_IN_BYTE;
+  const size_t tableBitSize = getTableBitSize(numberOfEntries, bitsPerCode);
+  if (tableBitSize + unusedBitsQuantity > streamBitSize)
+    throw DecoderException("Truncated input");
+
+  table = readTable(input + HEADER_SIZE, tableBitSize, bitsPerCode);
+  data = BitStream{input + HEADER_SIZE, tableBitSize,
+                   streamBitSize - tableBitSize - unusedBitsQuantity};
+}
+
+bool Decoder::isStored(const uint8_t* input, const size_t inputSize)
+{
+  return input != nullptr && inputSize != 0 &&
+    input[0] == format::STORED_MARKER;
+}
+
+bool Decoder::isExtended(const uint8_t* input, const size_t inputSize)
+{
+  return input != nullptr && inputSize != 0 &&
+    input[0] == format::EXTENDED_MARKER;
+}
+
+size_t Decoder::parseExtendedHeader(const uint8_t* input,
+                                    const size_t inputSize, uint8_t& flags,
+                                    ExtendedLayout& layout)
+{
+  constexpr size_t INDEX_FLAGS = 1;
+  constexpr size_t INDEX_STREAM_COUNT = 2;
+
+  if (inputSize < format::EXTENDED_HEADER_SIZE)
+    throw DecoderException("Incorrect header format");
+  flags = input[INDEX_FLAGS];
+  if (flags & ~format::KNOWN_FLAGS)
+    throw DecoderException("Unsupported format flags");
+
+  layout.streamCount = input[INDEX_STREAM_COUNT];
+  if (!format::isValidStreamCount(layout.streamCount))
+    throw DecoderException("Unsupported stream count");
+
+  size_t offset = format::EXTENDED_HEADER_SIZE +
+    layout.streamCount * format::STREAM_LENGTH_SIZE;
+  if (inputSize < offset)
+    throw DecoderException("Truncated input");
+
+  layout.hasOriginalSize = (flags & format::FLAG_ORIGINAL_SIZE) != 0;
+  layout.originalSize = 0;
+  if (layout.hasOriginalSize)
   {
-    file_io::checkFiles(inputFilePath, outputFilePath);
-    const Buffer rawBuffer = file_io::readFileToBuffer(inputFilePath);
-    constexpr size_t HEADER_SIZE = 3;
-    constexpr size_t INDEX_UNUSED_BITS_QUANTITY = 0;
-    constexpr size_t INDEX_NUM_OF_ENTRIES = 1;
-    constexpr size_t INDEX_BITS_PER_CODE = 2;
-
-    if (rawBuffer.size() < HEADER_SIZE)
-      throw DecoderException("Incorrect header format");
-
-    const uint8_t unusedBitsQuantity = rawBuffer[INDEX_UNUSED_BITS_QUANTITY];
-    const uint8_t numberOfEntries = rawBuffer[INDEX_NUM_OF_ENTRIES];
-    const uint8_t bitsPerCode = rawBuffer[INDEX_BITS_PER_CODE];
-
-    const Buffer cleanedBuffer(rawBuffer.begin() + 3, rawBuffer.end());
-    const Encoded encodedBuffer = bit_utils::byteBufferToBits(cleanedBuffer);
-
-    const size_t tableBitSize = getTableBitSize(numberOfEntries, bitsPerCode);
-    const Encoded encodedTable(
-      encodedBuffer.begin(),
-      encodedBuffer.begin() + tableBitSize
-    );
-    const Encoded encodedData(
-      encodedBuffer.begin() + tableBitSize,
-      encodedBuffer.end() - unusedBitsQuantity
-    );
+    if (inputSize - offset < format::ORIGINAL_SIZE_SIZE)
+      throw DecoderException("Truncated input");
+    const uint64_t size = format::loadLittleEndian(
+      input + offset, format::ORIGINAL_SIZE_SIZE);
+    if (size > SIZE_MAX)
+      throw DecoderException("Original size is too large");
+    layout.originalSize = static_cast<size_t>(size);
+    offset += format::ORIGINAL_SIZE_SIZE;
+  }
+  return offset;
+}
 
-    Table table;
-    table.decode(encodedTable, bitsPerCode);
+void Decoder::parseExtended(const uint8_t* input, const size_t inputSize,
+                            ExtendedLayout& layout)
+{
+  ProfileScope phase("decode table");
+
+  uint8_t flags;
+  size_t offset = parseExtendedHeader(input, inputSize, flags, layout);
+  const uint8_t* lengths = input + format::EXTENDED_HEADER_SIZE;
 
-    Data data;
-    data.decode(table, encodedData);
+  layout.syncInterval = 0;
+  layout.syncPointCount = 0;
+  layout.syncOffsets = nullptr;
+  layout.syncedSize = 0;
+  if (flags & format::FLAG_SYNC_INDEX)
+  {
+    if (inputSize - offset < format::SYNC_HEADER_SIZE)
+      throw DecoderException("Truncated input");
+    layout.syncInterval = static_cast<size_t>(
+      format::loadLittleEndian(input + offset, format::SYNC_FIELD_SIZE));
+    layout.syncPointCount = static_cast<size_t>(format::loadLittleEndian(
+      input + offset + format::SYNC_FIELD_SIZE, format::SYNC_FIELD_SIZE));
+    offset += format::SYNC_HEADER_SIZE;
+    if (layout.syncInterval == 0 && layout.syncPointCount != 0)
+      throw DecoderException("Corrupt sync index");
 
-    file_io::writeToFile(outputFilePath, data.getData());
+    const uint64_t indexSize = static_cast<uint64_t>(layout.syncPointCount) *
+      layout.streamCount * format::SYNC_OFFSET_SIZE;
+    if (indexSize > inputSize - offset)
+      throw DecoderException("Truncated input");
+    layout.syncOffsets = input + offset;
+    offset += static_cast<size_t>(indexSize);
   }
-  catch (const std::exception& ex)
+
+  if (inputSize - offset < format::TABLE_HEADER_SIZE)
+    throw DecoderException("Truncated input");
+  const uint8_t numberOfEntries = input[offset];
+  const uint8_t bitsPerCode = input[offset + 1];
+  const size_t recordsStart = offset + format::TABLE_HEADER_SIZE;
+  const size_t tableBitSize = getTableBitSize(numberOfEntries, bitsPerCode);
+  const size_t tableByteSize = (tableBitSize + bit_utils::BITS_IN_BYTE - 1) /
+    bit_utils::BITS_IN_BYTE;
+  if (inputSize - recordsStart < tableByteSize)
+    throw DecoderException("Truncated input");
+
+  offset = recordsStart + tableByteSize;
+  for (size_t stream = 0; stream < layout.streamCount; stream++)
   {
-    scopedTimer.suppress();
-    std::cerr << ex.what() << "\n";
+    const uint64_t bitCount = format::loadLittleEndian(
+      lengths + stream * format::STREAM_LENGTH_SIZE,
+      format::STREAM_LENGTH_SIZE);
+
+    // compared in bytes so a huge length cannot overflow
+    const uint64_t byteCount = bitCount / bit_utils::BITS_IN_BYTE +
+      (bitCount % bit_utils::BITS_IN_BYTE != 0);
+    if (byteCount > inputSize - offset)
+      throw DecoderException("Truncated input");
+
+    layout.streams[stream] = BitStream{input + offset, 0,
+                                       static_cast<size_t>(bitCount)};
+    offset += static_cast<size_t>(byteCount);
+  }
+  if (offset != inputSize)
+    throw DecoderException("Trailing data after sub-streams");
+
+  // every symbol takes at least a bit, which bounds the output allocated
+  // from the recorded size and the sync index
+  uint64_t totalBits = 0;
+  for (size_t stream = 0; stream < layout.streamCount; stream++)
+    totalBits += layout.streams[stream].bitCount;
+  if (layout.originalSize > totalBits)
+    throw DecoderException("Original size does not match the data");
+  checkSyncIndex(layout, totalBits);
+
+  layout.table = readTable(input + recordsStart, tableBitSize, bitsPerCode);
+}
+
+void Decoder::checkSyncIndex(ExtendedLayout& layout, const uint64_t totalBits)
+{
+  if (layout.syncPointCount == 0)
+    return;
+
+  // Offsets must climb within each sub-stream.
+  const size_t streamCount = layout.streamCount;
+  for (size_t stream = 0; stream < streamCount; stream++)
+  {
+    uint64_t previous = 0;
+    for (size_t point = 0; point < layout.syncPointCount; point++)
+    {
+      const uint64_t offset = format::loadLittleEndian(
+        layout.syncOffsets + (point * streamCount + stream) *
+        format::SYNC_OFFSET_SIZE, format::SYNC_OFFSET_SIZE);
+      if (offset < previous || offset > layout.streams[stream].bitCount)
+        throw DecoderException("Corrupt sync index");
+      previous = offset;
+    }
   }
+
+  // Every symbol takes at least a bit, so the output before the last
+  // point cannot exceed the data's bit count; the divisions keep the
+  // products below from overflowing.
+  if (layout.syncInterval > SIZE_MAX / streamCount)
+    throw DecoderException("Corrupt sync index");
+  const size_t chunkSymbols = layout.syncInterval * streamCount;
+  if (layout.syncPointCount > totalBits / chunkSymbols ||
+    layout.syncPointCount > SIZE_MAX / chunkSymbols)
+    throw DecoderException("Corrupt sync index");
+  layout.syncedSize = layout.syncPointCount * chunkSymbols;
+
+  // points are only written below the input size
+  if (layout.hasOriginalSize && layout.originalSize <= layout.syncedSize)
+    throw DecoderException("Corrupt sync index");
+}
+
+void Decoder::decodeSyncChunks(const ExtendedLayout& layout,
+                               const size_t threads, uint8_t* output,
+                               Buffer* tail)
+{
+  // parseExtended has checked the index
+  const size_t streamCount = layout.streamCount;
+  const size_t chunkCount = layout.syncPointCount + 1;
+  const size_t chunkSymbols = layout.syncInterval * streamCount;
+  const size_t fixedSize = layout.syncedSize;
+
+  const auto chunkStreams = [&](const size_t chunk, BitStream* streams)
+  {
+    for (size_t stream = 0; stream < streamCount; stream++)
+    {
+      const BitStream& whole = layout.streams[stream];
+      const auto offsetAt = [&](const size_t point) -> size_t
+      {
+        return static_cast<size_t>(format::loadLittleEndian(
+          layout.syncOffsets + (point * streamCount + stream) *
+          format::SYNC_OFFSET_SIZE, format::SYNC_OFFSET_SIZE));
+      };
+      const size_t begin = chunk == 0 ? 0 : offsetAt(chunk - 1);
+      const size_t end = chunk == layout.syncPointCount
+                           ? whole.bitCount
+                           : offsetAt(chunk);
+      streams[stream] = BitStream{whole.bytes, begin, end - begin};
+    }
+  };
+
+  // one reader's lookup tables, copied to each thread
+  const DataReader shared(layout.table, layout.streams, streamCount);
+  const size_t workers = std::min(threads, chunkCount);
+  std::unique_ptr<std::exception_ptr[]> errors(
+    new std::exception_ptr[workers]);
+
+  const auto work = [&](const size_t worker)
+  {
+    try
+    {
+      DataReader reader = shared;
+      BitStream streams[format::MAX_STREAMS];
+      for (size_t chunk = worker * chunkCount / workers;
+           chunk < (worker + 1) * chunkCount / workers; chunk++)
+      {
+        chunkStreams(chunk, streams);
+        reader.restart(streams, streamCount);
+        if (chunk == layout.syncPointCount)
+        {
+          if (tail)
+            readAll(reader, *tail);
+          else
+            readExactly(reader, output + fixedSize,
+                        layout.originalSize - fixedSize);
+          continue;
+        }
+
+        const size_t produced = reader.read(output + chunk * chunkSymbols,
+                                            chunkSymbols);
+        if (produced != chunkSymbols || !reader.atEnd())
+          throw DecoderException("Sync index does not match the data");
+      }
+    }
+    catch (...)
+    {
+      errors[worker] = std::current_exception();
+    }
+  };
+
+  {
+    std::unique_ptr<std::thread[]> pool(new std::thread[workers - 1]);
+    for (size_t worker = 1; worker < workers; worker++)
+      pool[worker - 1] = std::thread(work, worker);
+    work(0);
+    for (size_t worker = 1; worker < workers; worker++)
+      pool[worker - 1].join();
+  }
+
+  for (size_t worker = 0; worker < workers; worker++)
+    if (errors[worker])
+      std::rethrow_exception(errors[worker]);
+}
+
+void Decoder::decodeSpeculatively(const Table& table, const BitStream& data,
+                                  const size_t threads, Buffer& output)
+{
+  // Below this many bits per thread, the resync and stitching cost more
+  // than the parallel part saves.
+  constexpr size_t MIN_CHUNK_BITS = 1 << 16;
+  // Code boundaries a speculative thread records for the stitch to meet.
+  // Paths through a prefix code usually merge within a few codes.
+  constexpr size_t SYNC_WINDOW = 256;
+
+  struct Speculation
+  {
+    Buffer output;
+    // starts[i] is where output[i] begins; starts[count - 1] is where
+    // recording stopped
+    size_t starts[SYNC_WINDOW + 1];
+    size_t count;
+    size_t end;
+    bool failed;
+  };
+
+  size_t maxCodeLength = 1;
+  for (const Pair<const uint8_t&, const ByteEntry&> pair : table.getRawTable())
+    maxCodeLength = std::max(maxCodeLength,
+                             static_cast<size_t>(pair.second.code.length));
+
+  const size_t dataEnd = data.bitOffset + data.bitCount;
+  const size_t chunkCount = std::min(threads, data.bitCount / MIN_CHUNK_BITS);
+  DataReader reader(table, &data, 1);
+  output.clear();
+  ProfileScope phase("decode data");
+  if (chunkCount < 2)
+  {
+    readAll(reader, output);
+    phase.addBytes(output.size());
+    return;
+  }
+
+  const auto boundary = [&](const size_t chunk)
+  {
+    return chunk == chunkCount
+             ? dataEnd
+             : data.bitOffset + data.bitCount / chunkCount * chunk;
+  };
+
+  // Chunk 0 starts on a code boundary, so its thread decodes the true path.
+  // The others record where their first codes start, then decode past the
+  // end of their chunk to the first code boundary at or after it.
+  std::unique_ptr<Speculation[]> speculations(new Speculation[chunkCount]);
+  const auto speculate = [&](const size_t chunk)
+  {
+    Speculation& speculation = speculations[chunk];
+    speculation.failed = false;
+    try
+    {
+      DataReader local = reader;
+      const BitStream rest = {data.bytes, boundary(chunk),
+                              dataEnd - boundary(chunk)};
+      local.restart(&rest, 1);
+
+      speculation.starts[0] = local.position();
+      speculation.count = 1;
+      uint8_t byte;
+      while (chunk != 0 && speculation.count <= SYNC_WINDOW &&
+        local.position() < boundary(chunk + 1) && local.read(&byte, 1) == 1)
+      {
+        speculation.output.pushBack(byte);
+        speculation.starts[speculation.count++] = local.position();
+      }
+      readUntil(local, boundary(chunk + 1), maxCodeLength,
+                speculation.output);
+      speculation.end = local.position();
+    }
+    catch (...)
+    {
+      // a wrong guess can hit bits that form no code, and a worker can
+      // run out of memory; the stitch decodes the chunk itself and
+      // reports real errors on the calling thread
+      speculation.failed = true;
+    }
+  };
+
+  {
+    std::unique_ptr<std::thread[]> pool(new std::thread[chunkCount - 1]);
+    for (size_t chunk = 1; chunk < chunkCount; chunk++)
+      pool[chunk - 1] = std::thread(speculate, chunk);
+    speculate(0);
+    for (size_t chunk = 1; chunk < chunkCount; chunk++)
+      pool[chunk - 1].join();
+  }
+
+  // Follow the true path: from where the previous chunk ended, decode
+  // until landing on a boundary the chunk's thread recorded, after which
+  // its output is the true output. Without a match, decode the chunk here.
+  for (size_t chunk = 0; chunk < chunkCount; chunk++)
+  {
+    const Speculation& speculation = speculations[chunk];
+    const size_t limit = boundary(chunk + 1);
+    bool synced = false;
+    size_t next = 0;
+    while (!speculation.failed)
+    {
+      const size_t position = reader.position();
+      while (next < speculation.count && speculation.starts[next] < position)
+        next++;
+      if (next < speculation.count && speculation.starts[next] == position)
+      {
+        output.append(speculation.output.data() + next,
+                      speculation.output.size() - next);
+        const BitStream rest = {data.bytes, speculation.end,
+                                dataEnd - speculation.end};
+        reader.restart(&rest, 1);
+        synced = true;
+        break;
+      }
+
+      uint8_t byte;
+      if (next == speculation.count || position >= limit ||
+        reader.read(&byte, 1) == 0)
+        break;
+      output.pushBack(byte);
+    }
+
+    if (!synced)
+      readUntil(reader, limit, maxCodeLength, output);
+  }
+
+  phase.addBytes(output.size());
+}
+
+void Decoder::readUntil(DataReader& reader, const size_t bitLimit,
+                        const size_t maxCodeLength, Buffer& output)
+{
+  // No code exceeds maxCodeLength, so a batch this size cannot pass the
+  // limit by more than the code that reaches it.
+  while (reader.position() < bitLimit)
+  {
+    const size_t batch = std::max<size_t>(
+      1, (bitLimit - reader.position()) / maxCodeLength);
+    const size_t offset = output.size();
+    output.resizeUninitialized(offset + batch);
+    const size_t produced = reader.read(output.data() + offset, batch);
+    output.resizeUninitialized(offset + produced);
+    if (produced == 0)
+      break;
+  }
+}
+
+Table Decoder::readTable(const uint8_t* records, const size_t tableBitSize,
+                         const uint8_t bitsPerCode)
+{
+  const size_t tableByteSize = (tableBitSize + bit_utils::BITS_IN_BYTE - 1) /
+    bit_utils::BITS_IN_BYTE;
+  const Encoded tableBits = Encoded::fromBytes(records, tableByteSize);
+  const Encoded encodedTable(tableBits.begin(),
+                             tableBits.begin() + tableBitSize);
+
+  Table table;
+  table.decode(encodedTable, bitsPerCode);
+  return table;
 }
 
 size_t Decoder::getTableBitSize(const uint8_t numberOfEntries,
                                 const uint8_t bitsPerCode)
 {
-  return numberOfEntries * (8 + bitsPerCode);
+  const size_t entries = numberOfEntries == 0
+                           ? Table::SYMBOL_COUNT
+                           : numberOfEntries;
+  return entries * (8 + bitsPerCode);
 }
@@ -0,0 +1,77 @@
+#include "../include/DecoderContext.h"
+
+DecoderContext::DecoderContext() : frameHeader_(), frameHeaderFilled_(0),
+                                   frameSize_(0)
+{
+}
+
+DecoderContext::DecoderContext(const DecoderContext&) = default;
+
+DecoderContext::DecoderContext(DecoderContext&&) noexcept = default;
+
+DecoderContext& DecoderContext::operator=(const DecoderContext&) = default;
+
+DecoderContext& DecoderContext::operator=(DecoderContext&&) = default;
+
+DecoderContext::~DecoderContext() = default;
+
+void DecoderContext::update(const uint8_t* bytes, size_t size,
+                            Buffer& output)
+{
+  if (bytes == nullptr && size != 0)
+    throw DecoderException("Input is null");
+
+  while (size > 0)
+  {
+    if (frameHeaderFilled_ < EncoderContext::FRAME_HEADER_SIZE)
+    {
+      frameHeader_[frameHeaderFilled_++] = *bytes++;
+      size--;
+      if (frameHeaderFilled_ < EncoderContext::FRAME_HEADER_SIZE)
+        continue;
+
+      frameSize_ = 0;
+      for (size_t i = 0; i < EncoderContext::FRAME_HEADER_SIZE; i++)
+        frameSize_ |= static_cast<size_t>(frameHeader_[i]) << i * 8;
+      if (frameSize_ == 0)
+        throw DecoderException("Empty frame");
+      frame_.clear();
+      continue;
+    }
+
+    // the whole frame is available in the caller's buffer - skip the copy
+    if (frame_.empty() && size >= frameSize_)
+    {
+      decodeFrame(bytes, frameSize_, output);
+      bytes += frameSize_;
+      size -= frameSize_;
+      continue;
+    }
+
+    const size_t chunk = std::min(size, frameSize_ - frame_.size());
+    frame_.append(bytes, chunk);
+    bytes += chunk;
+    size -= chunk;
+    if (frame_.size() == frameSize_)
+      decodeFrame(frame_.data(), frame_.size(), output);
+  }
+}
+
+void DecoderContext::finish()
+{
+  if (frameHeaderFilled_ != 0)
+    throw DecoderException("Stream ended in the middle of a frame");
+}
+
+void DecoderContext::decodeFrame(const uint8_t* frame, const size_t size,
+                                 Buffer& output)
+{
+  {
+    MemoryResourceScope scope(&arena_);
+    Decoder::decode(frame, size, decoded_);
+  }
+  arena_.reset();
+  output += decoded_;
+  frameHeaderFilled_ = 0;
+  frame_.clear();
+}
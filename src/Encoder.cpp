@@ -2,6 +2,9 @@
 
 #include <iomanip>
 
+constexpr size_t EncoderOptions::DEFAULT_SYNC_INTERVAL;
+
+
 Encoder::Encoder() = default;
 
 Encoder::Encoder(const Encoder&) = default;
@@ -14,23 +17,29 @@ Encoder& Encoder::operator=(Encoder&&) noexcept = default;
 
 Encoder::~Encoder() = default;
 
-void Encoder::encode(const String& inputFilePath, const String& outputFilePath)
+void Encoder::encode(const String& inputFilePath, const String& outputFilePath,
+                     const EncoderOptions& options)
 {
   ScopedTimer scopedTimer("Encoder");
   try
   {
+    checkOptions(options);
     file_io::checkFiles(inputFilePath, outputFilePath);
-    const Buffer buffer = file_io::readFileToBuffer(inputFilePath);
-    Table table(buffer);
-    Data data(buffer);
-
-    const Encoded encodedTable = table.encode();
-    const Encoded encodedData = data.encode(table);
+    Buffer buffer;
+    {
+      ProfileScope phase("read");
+      buffer = file_io::readFileToBuffer(inputFilePath);
+      phase.addBytes(buffer.size());
+    }
 
+    Table table(buffer);
     const Packed packed =
-      packEncodedTableAndData(encodedTable, encodedData);
+      encodeWithTable(table, buffer.data(), buffer.size(), options);
 
-    file_io::writeToFile(outputFilePath, packed);
+    {
+      ProfileScope phase("write", packed.size());
+      file_io::writeToFile(outputFilePath, packed);
+    }
 
     getStatistics(inputFilePath, outputFilePath, table);
   }
@@ -41,6 +50,107 @@ void Encoder::encode(const String& inputFilePath, const String& outputFilePath)
   }
 }
 
+void Encoder::encode(const uint8_t* input, const size_t inputSize,
+                     Packed& output, const EncoderOptions& options)
+{
+  checkOptions(options);
+  if (input == nullptr || inputSize == 0)
+    throw EncoderException("Input is empty");
+
+  Table table(input, inputSize);
+  output = encodeWithTable(table, input, inputSize, options);
+}
+
+void Encoder::checkOptions(const EncoderOptions& options)
+{
+  if (!format::isValidStreamCount(options.streams))
+    throw EncoderException("Stream count must be 1, 2, 4 or 8");
+  if (options.syncInterval > UINT32_MAX)
+    throw EncoderException("Sync interval must fit in 32 bits");
+}
+
+Packed Encoder::encodeWithTable(Table& table, const uint8_t* input,
+                                const size_t inputSize,
+                                const EncoderOptions& options)
+{
+  Encoded encodedTable;
+  {
+    ProfileScope phase("encode table");
+    encodedTable = table.encode();
+  }
+
+  if (options.allowStored &&
+    codedSize(table, encodedTable, inputSize, options) >=
+    inputSize + format::STORED_HEADER_SIZE)
+  {
+    ProfileScope phase("pack", inputSize);
+    return packStored(input, inputSize);
+  }
+
+  if (options.streams > 1 || options.syncInterval != 0 || options.recordSize)
+  {
+    Vector<Encoded> streams;
+    Vector<uint64_t> syncOffsets;
+    {
+      ProfileScope phase("encode data", inputSize);
+      streams = Data::encodeStreams(table, input, inputSize, options.streams,
+                                    options.syncInterval, &syncOffsets);
+    }
+
+    ProfileScope phase("pack");
+    Packed packed = packEncodedTableAndStreams(encodedTable, streams, options,
+                                               inputSize, syncOffsets);
+    phase.addBytes(packed.size());
+    return packed;
+  }
+
+  Encoded encodedData;
+  {
+    ProfileScope phase("encode data", inputSize);
+    encodedData = Data::encode(table, input, inputSize);
+  }
+
+  ProfileScope phase("pack");
+  Packed packed = packEncodedTableAndData(encodedTable, encodedData);
+  phase.addBytes(packed.size());
+  return packed;
+}
+
+size_t Encoder::codedSize(const Table& table, const Encoded& encodedTable,
+                          const size_t inputSize,
+                          const EncoderOptions& options)
+{
+  uint64_t dataBits = 0;
+  for (const Pair<const uint8_t&, const ByteEntry&> pair : table.getRawTable())
+    dataBits += pair.second.occurrences * pair.second.code.length;
+
+  constexpr size_t BITS = bit_utils::BITS_IN_BYTE;
+  const size_t streams = options.streams;
+  if (streams == 1 && options.syncInterval == 0 && !options.recordSize)
+    return format::LEGACY_HEADER_SIZE - format::TABLE_HEADER_SIZE +
+      (encodedTable.size() + dataBits + BITS - 1) / BITS;
+
+  size_t size = format::EXTENDED_HEADER_SIZE +
+    streams * format::STREAM_LENGTH_SIZE +
+    (encodedTable.size() + BITS - 1) / BITS +
+    (dataBits + BITS - 1) / BITS + (streams - 1);
+  if (options.recordSize)
+    size += format::ORIGINAL_SIZE_SIZE;
+  if (options.syncInterval && inputSize != 0)
+    size += format::SYNC_HEADER_SIZE + (inputSize - 1) /
+      options.syncInterval / streams * streams * format::SYNC_OFFSET_SIZE;
+  return size;
+}
+
+Packed Encoder::packStored(const uint8_t* input, const size_t inputSize)
+{
+  Packed packed;
+  packed.reserve(format::STORED_HEADER_SIZE + inputSize);
+  packed.pushBack(format::STORED_MARKER);
+  packed.append(input, inputSize);
+  return packed;
+}
+
 Packed Encoder::packEncodedTableAndData(const Encoded& encodedTable,
                                         const Encoded& encodedData)
 {
@@ -59,6 +169,61 @@ Packed Encoder::packEncodedTableAndData(const Encoded& encodedTable,
   return packed;
 }
 
+Packed Encoder::packEncodedTableAndStreams(const Encoded& encodedTable,
+                                           const Vector<Encoded>& streams,
+                                           const EncoderOptions& options,
+                                           const size_t inputSize,
+                                           const Vector<uint64_t>& syncOffsets)
+{
+  const size_t syncInterval = options.syncInterval;
+  uint8_t flags = 0;
+  if (syncInterval)
+    flags |= format::FLAG_SYNC_INDEX;
+  if (options.recordSize)
+    flags |= format::FLAG_ORIGINAL_SIZE;
+
+  uint8_t field[format::STREAM_LENGTH_SIZE];
+  Packed packed;
+  packed.pushBack(format::EXTENDED_MARKER);
+  packed.pushBack(flags);
+  packed.pushBack(static_cast<uint8_t>(streams.size()));
+  for (const Encoded& stream : streams)
+  {
+    format::storeLittleEndian(field, stream.size(), sizeof(field));
+    packed.append(field, sizeof(field));
+  }
+
+  if (options.recordSize)
+  {
+    format::storeLittleEndian(field, inputSize, format::ORIGINAL_SIZE_SIZE);
+    packed.append(field, format::ORIGINAL_SIZE_SIZE);
+  }
+
+  if (syncInterval)
+  {
+    const size_t pointCount = syncOffsets.size() / streams.size();
+    if (pointCount > UINT32_MAX)
+      throw EncoderException("Too many sync points");
+
+    format::storeLittleEndian(field, syncInterval, format::SYNC_FIELD_SIZE);
+    packed.append(field, format::SYNC_FIELD_SIZE);
+    format::storeLittleEndian(field, pointCount, format::SYNC_FIELD_SIZE);
+    packed.append(field, format::SYNC_FIELD_SIZE);
+    for (const uint64_t offset : syncOffsets)
+    {
+      format::storeLittleEndian(field, offset, format::SYNC_OFFSET_SIZE);
+      packed.append(field, format::SYNC_OFFSET_SIZE);
+    }
+  }
+
+  // every block is padded to a byte, so sub-streams start byte-aligned
+  packed += bit_utils::packBits(encodedTable);
+  for (const Encoded& stream : streams)
+    packed += bit_utils::packBits(stream);
+
+  return packed;
+}
+
 void Encoder::getStatistics(const String& inputFilePath,
                             const String& outputFilePath, const Table& table)
 {
@@ -0,0 +1,67 @@
+#include "../include/EncoderContext.h"
+
+EncoderContext::EncoderContext(const size_t blockSize) : blockSize_(blockSize)
+{
+  if (blockSize_ == 0)
+    throw EncoderException("Block size must be positive");
+
+  block_.reserve(blockSize_);
+}
+
+EncoderContext::EncoderContext(const EncoderContext&) = default;
+
+EncoderContext::EncoderContext(EncoderContext&&) noexcept = default;
+
+EncoderContext& EncoderContext::operator=(const EncoderContext&) = default;
+
+EncoderContext& EncoderContext::operator=(EncoderContext&&) = default;
+
+EncoderContext::~EncoderContext() = default;
+
+void EncoderContext::update(const uint8_t* bytes, const size_t size,
+                            Packed& output)
+{
+  if (bytes == nullptr && size != 0)
+    throw EncoderException("Input is null");
+
+  size_t consumed = 0;
+  while (consumed < size)
+  {
+    const size_t chunk = std::min(size - consumed,
+                                  blockSize_ - block_.size());
+    block_.append(bytes + consumed, chunk);
+    consumed += chunk;
+    if (block_.size() == blockSize_)
+      flushBlock(output);
+  }
+}
+
+void EncoderContext::finish(Packed& output)
+{
+  if (!block_.empty())
+    flushBlock(output);
+}
+
+size_t EncoderContext::blockSize() const
+{
+  return blockSize_;
+}
+
+void EncoderContext::flushBlock(Packed& output)
+{
+  {
+    MemoryResourceScope scope(&arena_);
+    Encoder::encode(block_.data(), block_.size(), packed_);
+  }
+  arena_.reset();
+  block_.clear();
+
+  const size_t packedSize = packed_.size();
+  if (static_cast<uint64_t>(packedSize) >> FRAME_HEADER_SIZE * 8 != 0)
+    throw EncoderException("Frame does not fit its size field");
+  uint8_t frameHeader[FRAME_HEADER_SIZE];
+  for (size_t i = 0; i < FRAME_HEADER_SIZE; i++)
+    frameHeader[i] = static_cast<uint8_t>(packedSize >> i * 8);
+  output.append(frameHeader, FRAME_HEADER_SIZE);
+  output += packed_;
+}
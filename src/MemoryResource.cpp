@@ -0,0 +1,74 @@
+#include "../include/MemoryResource.h"
+
+#include <cstdint>
+#include <new>
+
+namespace
+{
+#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
+  constexpr size_t DEFAULT_NEW_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+  constexpr size_t DEFAULT_NEW_ALIGNMENT = alignof(std::max_align_t);
+#endif
+
+  class NewDeleteResource : public MemoryResource
+  {
+  public:
+    void* allocate(const size_t bytes, const size_t alignment) override
+    {
+      if (alignment <= DEFAULT_NEW_ALIGNMENT)
+        return ::operator new(bytes);
+
+#ifdef __cpp_aligned_new
+      return ::operator new(bytes, std::align_val_t(alignment));
+#else
+      // over-allocate and keep the block's start just below the result
+      const uintptr_t raw = reinterpret_cast<uintptr_t>(
+        ::operator new(bytes + alignment + sizeof(void*)));
+      const uintptr_t aligned = (raw + sizeof(void*) + alignment - 1) &
+        ~(alignment - 1);
+      reinterpret_cast<void**>(aligned)[-1] = reinterpret_cast<void*>(raw);
+      return reinterpret_cast<void*>(aligned);
+#endif
+    }
+
+    void deallocate(void* pointer, size_t, const size_t alignment) override
+    {
+      if (alignment <= DEFAULT_NEW_ALIGNMENT)
+      {
+        ::operator delete(pointer);
+        return;
+      }
+
+#ifdef __cpp_aligned_new
+      ::operator delete(pointer, std::align_val_t(alignment));
+#else
+      if (pointer != nullptr)
+        ::operator delete(static_cast<void**>(pointer)[-1]);
+#endif
+    }
+  };
+}
+
+thread_local MemoryResource* MemoryResource::current_ = nullptr;
+
+MemoryResource::~MemoryResource() = default;
+
+MemoryResource* MemoryResource::defaultResource()
+{
+  // never destroyed: containers with static storage may still release
+  // memory after other statics are gone
+  static MemoryResource* const resource = new NewDeleteResource();
+  return resource;
+}
+
+MemoryResourceScope::MemoryResourceScope(MemoryResource* resource) :
+  previous_(MemoryResource::current_)
+{
+  MemoryResource::current_ = resource;
+}
+
+MemoryResourceScope::~MemoryResourceScope()
+{
+  MemoryResource::current_ = previous_;
+}
@@ -0,0 +1,167 @@
+#include "../include/PerfCounters.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  std::atomic<unsigned> openedEvents(0);
+
+#ifdef __linux__
+  struct EventConfig
+  {
+    uint32_t type;
+    uint64_t config;
+  };
+
+  constexpr uint64_t cacheReadMiss(const uint64_t cache)
+  {
+    return cache | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+      PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+  }
+
+  const EventConfig EVENTS[PerfCounters::EVENT_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_LL)},
+  };
+
+  // All events of a thread form one group led by the first event that
+  // opens, so a sample is a single read() of values in opening order.
+  class CounterGroup
+  {
+  public:
+    CounterGroup() : leader_(-1), openCount_(0), order_()
+    {
+      for (size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+      {
+        const int fd = open(EVENTS[i], leader_);
+        if (fd < 0)
+          continue;
+        if (leader_ < 0)
+          leader_ = fd;
+        fds_[openCount_] = fd;
+        order_[openCount_++] = static_cast<PerfCounters::Event>(i);
+        openedEvents.fetch_or(1u << i, std::memory_order_relaxed);
+      }
+
+      if (leader_ >= 0)
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    CounterGroup(const CounterGroup&) = delete;
+
+    CounterGroup& operator=(const CounterGroup&) = delete;
+
+    ~CounterGroup()
+    {
+      for (size_t i = 0; i < openCount_; i++)
+        close(fds_[i]);
+    }
+
+    bool read(PerfCounters::Sample& sample) const
+    {
+      if (leader_ < 0)
+        return false;
+
+      // count, time enabled, time running, then the values
+      constexpr size_t HEADER = 3;
+      uint64_t buffer[HEADER + PerfCounters::EVENT_COUNT];
+      const ssize_t bytes = ::read(leader_, buffer, sizeof(buffer));
+      if (bytes < static_cast<ssize_t>(HEADER * sizeof(uint64_t)) ||
+        buffer[0] != openCount_)
+        return false;
+
+      std::memset(sample.values, 0, sizeof(sample.values));
+      sample.timeEnabled = buffer[1];
+      sample.timeRunning = buffer[2];
+      for (size_t i = 0; i < openCount_; i++)
+        sample.values[order_[i]] = buffer[HEADER + i];
+      return true;
+    }
+
+  private:
+    int leader_;
+    size_t openCount_;
+    int fds_[PerfCounters::EVENT_COUNT];
+    PerfCounters::Event order_[PerfCounters::EVENT_COUNT];
+
+    static int open(const EventConfig& event, const int groupFd)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = event.type;
+      attr.config = event.config;
+      attr.disabled = groupFd < 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+        PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+  };
+#endif
+}
+
+bool PerfCounters::sample(Sample& sample)
+{
+#ifdef __linux__
+  thread_local const CounterGroup group;
+  return group.read(sample);
+#else
+  (void)sample;
+  return false;
+#endif
+}
+
+bool PerfCounters::difference(const Sample& start, const Sample& end,
+                              uint64_t* counts)
+{
+  const uint64_t enabled = end.timeEnabled - start.timeEnabled;
+  const uint64_t running = end.timeRunning - start.timeRunning;
+  if (running == 0)
+    return false;
+
+  const double scale = running < enabled
+                         ? static_cast<double>(enabled) / running
+                         : 1.0;
+  for (size_t i = 0; i < EVENT_COUNT; i++)
+    counts[i] = static_cast<uint64_t>(
+      static_cast<double>(end.values[i] - start.values[i]) * scale + 0.5);
+  return true;
+}
+
+unsigned PerfCounters::availableEvents()
+{
+  return openedEvents.load(std::memory_order_relaxed);
+}
+
+const char* PerfCounters::name(const Event event)
+{
+  switch (event)
+  {
+  case CYCLES:
+    return "cycles";
+  case INSTRUCTIONS:
+    return "instructions";
+  case BRANCH_MISSES:
+    return "branchMisses";
+  case L1D_MISSES:
+    return "l1dMisses";
+  case LLC_MISSES:
+    return "llcMisses";
+  default:
+    return "unknown";
+  }
+}
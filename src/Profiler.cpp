@@ -0,0 +1,363 @@
+#include "../include/Profiler.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "../include/MemoryResource.h"
+#include "../include/String.h"
+#include "../include/Vector.h"
+
+using namespace std::chrono;
+
+namespace
+{
+  struct PhaseNode
+  {
+    String name;
+    size_t parent;
+    uint64_t calls;
+    uint64_t nanoseconds;
+    uint64_t bytes;
+    uint64_t counters[PerfCounters::EVENT_COUNT];
+  };
+
+  constexpr size_t ROOT = 0;
+
+  // Index of the child of `parent` called `name`, created if missing.
+  size_t findOrAddChild(Vector<PhaseNode>& nodes, const size_t parent,
+                        const char* name)
+  {
+    for (size_t i = 1; i < nodes.size(); i++)
+      if (nodes[i].parent == parent &&
+        std::strcmp(nodes[i].name.c_str(), name) == 0)
+        return i;
+
+    nodes.pushBack(PhaseNode{String(name), parent, 0, 0, 0, {}});
+    return nodes.size() - 1;
+  }
+
+  Vector<PhaseNode> makeTree()
+  {
+    Vector<PhaseNode> nodes;
+    nodes.pushBack(PhaseNode{String(""), ROOT, 0, 0, 0, {}});
+    return nodes;
+  }
+
+  double megabytesPerSecond(const PhaseNode& node)
+  {
+    if (node.bytes == 0 || node.nanoseconds == 0)
+      return 0.0;
+    return static_cast<double>(node.bytes) * 1e3 / node.nanoseconds;
+  }
+
+  bool has(const unsigned events, const PerfCounters::Event event)
+  {
+    return events >> event & 1;
+  }
+
+  double perByte(const PhaseNode& node, const PerfCounters::Event event)
+  {
+    return static_cast<double>(node.counters[event]) / node.bytes;
+  }
+
+  double instructionsPerCycle(const PhaseNode& node)
+  {
+    const uint64_t cycles = node.counters[PerfCounters::CYCLES];
+    return cycles ? static_cast<double>(
+      node.counters[PerfCounters::INSTRUCTIONS]) / cycles : 0.0;
+  }
+
+  // Event columns of the table, after IPC.
+  const PerfCounters::Event MISS_EVENTS[] = {
+    PerfCounters::BRANCH_MISSES, PerfCounters::L1D_MISSES,
+    PerfCounters::LLC_MISSES
+  };
+
+  void writeTableHeader(std::ostream& os, const unsigned events)
+  {
+    os << "[Profile] " << std::left << std::setw(28) << "phase"
+      << std::right << std::setw(8) << "calls" << std::setw(14) << "time (ms)"
+      << std::setw(14) << "bytes" << std::setw(12) << "MB/s";
+    if (events)
+      os << std::setw(8) << "IPC" << std::setw(12) << "br-miss/B"
+        << std::setw(12) << "L1-miss/B" << std::setw(12) << "LLC-miss/B";
+    os << "\n";
+  }
+
+  void writeTable(std::ostream& os, const Vector<PhaseNode>& nodes,
+                  const size_t parent, const size_t depth,
+                  const unsigned events)
+  {
+    for (size_t i = 1; i < nodes.size(); i++)
+    {
+      const PhaseNode& node = nodes[i];
+      if (node.parent != parent)
+        continue;
+
+      const std::string label = std::string(depth * 2, ' ') +
+        node.name.c_str();
+      os << "[Profile] " << std::left << std::setw(28) << label
+        << std::right << std::setw(8) << node.calls
+        << std::setw(14) << std::fixed << std::setprecision(3)
+        << node.nanoseconds / 1e6
+        << std::setw(14) << node.bytes << std::setprecision(1);
+      if (node.bytes)
+        os << std::setw(12) << megabytesPerSecond(node);
+      else
+        os << std::setw(12) << "-";
+
+      if (events)
+      {
+        os << std::setprecision(2);
+        if (has(events, PerfCounters::CYCLES) &&
+          has(events, PerfCounters::INSTRUCTIONS))
+          os << std::setw(8) << instructionsPerCycle(node);
+        else
+          os << std::setw(8) << "-";
+
+        os << std::setprecision(4);
+        for (const PerfCounters::Event event : MISS_EVENTS)
+          if (node.bytes && has(events, event))
+            os << std::setw(12) << perByte(node, event);
+          else
+            os << std::setw(12) << "-";
+      }
+      os << "\n";
+      writeTable(os, nodes, i, depth + 1, events);
+    }
+  }
+
+  void writeJsonCounters(std::ostream& os, const PhaseNode& node,
+                         const unsigned events)
+  {
+    for (size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+    {
+      const PerfCounters::Event event = static_cast<PerfCounters::Event>(i);
+      if (has(events, event))
+        os << ", \"" << PerfCounters::name(event) << "\": "
+          << node.counters[event];
+    }
+
+    if (has(events, PerfCounters::CYCLES) &&
+      has(events, PerfCounters::INSTRUCTIONS))
+      os << ", \"ipc\": " << std::setprecision(3) << instructionsPerCycle(node);
+
+    if (node.bytes)
+      for (const PerfCounters::Event event : MISS_EVENTS)
+        if (has(events, event))
+          os << ", \"" << PerfCounters::name(event) << "PerByte\": "
+            << std::setprecision(5) << perByte(node, event);
+  }
+
+  void writeJson(std::ostream& os, const Vector<PhaseNode>& nodes,
+                 const size_t parent, const std::string& prefix,
+                 const unsigned events, bool& first)
+  {
+    for (size_t i = 1; i < nodes.size(); i++)
+    {
+      const PhaseNode& node = nodes[i];
+      if (node.parent != parent)
+        continue;
+
+      const std::string path = prefix.empty()
+                                 ? node.name.c_str()
+                                 : prefix + "/" + node.name.c_str();
+      os << (first ? "\n" : ",\n")
+        << "    {\"path\": \"" << path << "\", \"calls\": " << node.calls
+        << ", \"ns\": " << node.nanoseconds << ", \"bytes\": " << node.bytes
+        << ", \"mbps\": " << std::fixed << std::setprecision(1)
+        << megabytesPerSecond(node);
+      writeJsonCounters(os, node, events);
+      os << "}";
+      first = false;
+      writeJson(os, nodes, i, path, events, first);
+    }
+  }
+}
+
+struct Profiler::ThreadProfile
+{
+  Vector<PhaseNode> nodes = makeTree();
+  size_t current = ROOT;
+};
+
+// Thread profiles outlive their threads so the exit report can see them;
+// nothing here is ever freed.
+struct Profiler::Registry
+{
+  std::mutex mutex;
+  Vector<ThreadProfile*> profiles;
+  Format format = Format::TABLE;
+  bool reportAtExit = false;
+};
+
+std::atomic<bool> Profiler::enabled_(false);
+
+std::atomic<bool> Profiler::countersEnabled_(false);
+
+void Profiler::enable()
+{
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::disable()
+{
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Profiler::enableCounters()
+{
+  countersEnabled_.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::reportAtExit(const Format format)
+{
+  Registry& state = registry();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.format = format;
+  if (!state.reportAtExit)
+  {
+    state.reportAtExit = true;
+    std::atexit(writeExitReport);
+  }
+}
+
+void Profiler::report(std::ostream& os, const Format format)
+{
+  Registry& state = registry();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  MemoryResourceScope scope(MemoryResource::defaultResource());
+
+  // merge the per-thread trees by phase path
+  Vector<PhaseNode> merged = makeTree();
+  for (const ThreadProfile* profile : state.profiles)
+  {
+    Vector<size_t> mapping(profile->nodes.size(), ROOT);
+    for (size_t i = 1; i < profile->nodes.size(); i++)
+    {
+      const PhaseNode& node = profile->nodes[i];
+      const size_t target = findOrAddChild(merged, mapping[node.parent],
+                                           node.name.c_str());
+      mapping[i] = target;
+      merged[target].calls += node.calls;
+      merged[target].nanoseconds += node.nanoseconds;
+      merged[target].bytes += node.bytes;
+      for (size_t e = 0; e < PerfCounters::EVENT_COUNT; e++)
+        merged[target].counters[e] += node.counters[e];
+    }
+  }
+
+  const unsigned events =
+    countersEnabled() ? PerfCounters::availableEvents() : 0;
+  const bool countersMissing = countersEnabled() && events == 0;
+
+  const std::ios::fmtflags flags = os.flags();
+  const std::streamsize precision = os.precision();
+  if (format == Format::JSON)
+  {
+    os << "{";
+    if (countersMissing)
+      os << "\"counters\": \"unavailable\", ";
+    os << "\"phases\": [";
+    bool first = true;
+    writeJson(os, merged, ROOT, "", events, first);
+    os << "\n]}\n";
+  }
+  else
+  {
+    if (countersMissing)
+      os << "[Profile] hardware counters unavailable, showing time only\n";
+    writeTableHeader(os, events);
+    writeTable(os, merged, ROOT, 0, events);
+  }
+  os.precision(precision);
+  os.flags(flags);
+}
+
+void Profiler::reset()
+{
+  Registry& state = registry();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  MemoryResourceScope scope(MemoryResource::defaultResource());
+  for (ThreadProfile* profile : state.profiles)
+  {
+    profile->nodes = makeTree();
+    profile->current = ROOT;
+  }
+}
+
+Profiler::Registry& Profiler::registry()
+{
+  static Registry* const instance = []
+  {
+    MemoryResourceScope scope(MemoryResource::defaultResource());
+    return new Registry();
+  }();
+  return *instance;
+}
+
+Profiler::ThreadProfile* Profiler::threadProfile()
+{
+  thread_local ThreadProfile* profile = nullptr;
+  if (profile == nullptr)
+  {
+    Registry& state = registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    MemoryResourceScope scope(MemoryResource::defaultResource());
+    profile = new ThreadProfile();
+    state.profiles.pushBack(profile);
+  }
+  return profile;
+}
+
+void Profiler::writeExitReport()
+{
+  report(std::cerr, registry().format);
+}
+
+ProfileScope::ProfileScope(const char* name, const uint64_t bytes) :
+  profile_(nullptr), node_(0), parent_(0), bytes_(bytes), counting_(false)
+{
+  if (!Profiler::enabled())
+    return;
+
+  profile_ = Profiler::threadProfile();
+  parent_ = profile_->current;
+  {
+    MemoryResourceScope scope(MemoryResource::defaultResource());
+    node_ = findOrAddChild(profile_->nodes, parent_, name);
+  }
+  profile_->current = node_;
+  counting_ = Profiler::countersEnabled() && PerfCounters::sample(counters_);
+  start_ = steady_clock::now();
+}
+
+ProfileScope::~ProfileScope()
+{
+  if (profile_ == nullptr)
+    return;
+
+  const auto elapsed = steady_clock::now() - start_;
+  PerfCounters::Sample end;
+  uint64_t counts[PerfCounters::EVENT_COUNT];
+  const bool counted = counting_ && PerfCounters::sample(end) &&
+    PerfCounters::difference(counters_, end, counts);
+
+  PhaseNode& node = profile_->nodes[node_];
+  if (counted)
+    for (size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+      node.counters[i] += counts[i];
+  node.calls++;
+  node.nanoseconds += duration_cast<nanoseconds>(elapsed).count();
+  node.bytes += bytes_;
+  profile_->current = parent_;
+}
+
+void ProfileScope::addBytes(const uint64_t bytes)
+{
+  bytes_ += bytes;
+}
@@ -3,7 +3,7 @@
 using namespace std::chrono;
 
 ScopedTimer::ScopedTimer(const std::string& label) :
-  label_(label), start_(high_resolution_clock::now())
+  label_(label), phase_(label_.c_str()), start_(steady_clock::now())
 {
 }
 
@@ -14,7 +14,7 @@ void ScopedTimer::suppress()
 
 ScopedTimer::~ScopedTimer()
 {
-  const auto end = high_resolution_clock::now();
+  const auto end = steady_clock::now();
   const auto duration = duration_cast<milliseconds>
     (end - start_).count();
   if (!isSuppressed)
@@ -1,33 +1,30 @@
 #include "../include/String.h"
 
-String::String() : data_(nullptr), length_(0)
+String::String() : data_(nullptr), length_(0),
+                   resource_(MemoryResource::current())
 {
 }
 
-String::String(const char* string)
+String::String(const char* string) : String()
 {
   if (string)
   {
     length_ = std::strlen(string);
-    data_ = new char[length_ + 1];
+    data_ = allocateData(length_);
     std::strcpy(data_, string);
   }
-  else
-  {
-    data_ = nullptr;
-    length_ = 0;
-  }
 }
 
-String::String(const String& other)
+String::String(const String& other) : String()
 {
   length_ = other.length_;
-  data_ = new char[length_ + 1];
-  std::strcpy(data_, other.data_);
+  data_ = allocateData(length_);
+  std::strcpy(data_, other.c_str());
 }
 
 String::String(String&& other) noexcept : data_(other.data_),
-                                          length_(other.length_)
+                                          length_(other.length_),
+                                          resource_(other.resource_)
 {
   other.data_ = nullptr;
   other.length_ = 0;
@@ -37,20 +34,23 @@ String& String::operator=(const String& other)
 {
   if (this != &other)
   {
-    delete[] data_;
+    releaseData();
     length_ = other.length_;
-    data_ = new char[length_ + 1];
-    std::strcpy(data_, other.data_);
+    data_ = allocateData(length_);
+    std::strcpy(data_, other.c_str());
   }
 
   return *this;
 }
 
-String& String::operator=(String&& other) noexcept
+String& String::operator=(String&& other)
 {
   if (this != &other)
   {
-    delete[] data_;
+    if (other.resource_ != resource_)
+      return *this = static_cast<const String&>(other);
+
+    releaseData();
     data_ = other.data_;
     length_ = other.length_;
     other.data_ = nullptr;
@@ -62,7 +62,7 @@ String& String::operator=(String&& other) noexcept
 
 String::~String()
 {
-  delete[] data_;
+  releaseData();
 }
 
 char& String::operator[](const size_t index)
@@ -103,11 +103,22 @@ bool String::operator!=(const String& other) const
 String String::operator+(const char* otherString) const
 {
   const size_t newLen = this->size() + std::strlen(otherString);
-  char* newData = new char[newLen + 1];
-  std::strcpy(newData, this->c_str());
-  std::strcat(newData, otherString);
-
-  String result(newData);
-  delete[] newData;
+  String result;
+  result.length_ = newLen;
+  result.data_ = result.allocateData(newLen);
+  std::strcpy(result.data_, this->c_str());
+  std::strcat(result.data_, otherString);
   return result;
 }
+
+char* String::allocateData(const size_t length)
+{
+  return static_cast<char*>(resource_->allocate(length + 1, alignof(char)));
+}
+
+void String::releaseData()
+{
+  if (data_)
+    resource_->deallocate(data_, length_ + 1, alignof(char));
+  data_ = nullptr;
+}
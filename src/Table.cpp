@@ -2,17 +2,23 @@
 
 #include <cmath>
 
+constexpr size_t Table::SYMBOL_COUNT;
+
 
 Table::Table(const Buffer& buffer)
 {
   if (buffer.empty())
     throw FileException("File is empty");
 
-  countByteFrequencies(buffer);
-  Vector<ByteEntry> tableVector = toVector();
-  sortTableVectorByFrequency(tableVector);
-  buildFanoCodes(tableVector, 0, tableVector.size());
-  fromVector(tableVector);
+  build(buffer.data(), buffer.size());
+}
+
+Table::Table(const uint8_t* bytes, const size_t size)
+{
+  if (bytes == nullptr || size == 0)
+    throw TableException("Input is empty");
+
+  build(bytes, size);
 }
 
 Table::Table() = default;
@@ -23,7 +29,7 @@ Table::Table(Table&&) noexcept = default;
 
 Table& Table::operator=(const Table&) = default;
 
-Table& Table::operator=(Table&&) noexcept = default;
+Table& Table::operator=(Table&&) = default;
 
 Table::~Table() = default;
 
@@ -33,16 +39,20 @@ Encoded Table::encode()
   if (bitsPerCode > 255)
     throw TableException("Code is too long");
 
+  // a table is never empty, so 0 entries stands for all 256
+  const size_t entries = table_.size() == SYMBOL_COUNT ? 0 : table_.size();
   Encoded encodedTable;
-  encodedTable += bit_utils::addLeadingZerosToCode(
-    bit_utils::byteToBits(table_.size()), bit_utils::BITS_IN_BYTE);
-  encodedTable += bit_utils::addLeadingZerosToCode(
-    bit_utils::byteToBits(bitsPerCode + 1), bit_utils::BITS_IN_BYTE);
+  encodedTable.appendBits(entries, bit_utils::BITS_IN_BYTE);
+  encodedTable.appendBits(bitsPerCode + 1, bit_utils::BITS_IN_BYTE);
 
   for (const Pair<const uint8_t&, const ByteEntry&> pair : table_)
   {
-    encodedTable += bit_utils::byteToBits(pair.first);
-    encodedTable += bit_utils::normalizeCode(pair.second.code, bitsPerCode);
+    const Code& code = pair.second.code;
+    encodedTable.appendBits(pair.first, bit_utils::BITS_IN_BYTE);
+    // normalised code: zero padding, a marker one, then the code itself
+    encodedTable.appendBits(0, bitsPerCode - code.length);
+    encodedTable.appendBits(1, 1);
+    encodedTable.appendBits(code.bits, code.length);
   }
 
   return encodedTable;
@@ -56,17 +66,13 @@ void Table::decode(const Encoded& encodedTable, const uint8_t bitsPerCode)
 
   for (size_t i = 0; i + recordSize <= encodedTable.size(); i += recordSize)
   {
-    Vector<bool> symbolBits(encodedTable.begin() + i,
-                            encodedTable.begin() + i +
-                            bit_utils::BITS_IN_BYTE);
-    Vector<bool> codeBits(encodedTable.begin() + i +
-                          bit_utils::BITS_IN_BYTE,
-                          encodedTable.begin() + i + recordSize);
-
     ByteEntry byteEntry;
-    byteEntry.byte = bit_utils::bitsToByte(symbolBits);
-    byteEntry.code = bit_utils::processCodeBuffer(codeBits);
-    table_[byteEntry.byte] = byteEntry;
+    byteEntry.byte = static_cast<uint8_t>(
+      encodedTable.getBits(i, bit_utils::BITS_IN_BYTE));
+    byteEntry.code = parseNormalizedCode(encodedTable,
+                                         i + bit_utils::BITS_IN_BYTE,
+                                         bitsPerCode);
+    table_[byteEntry.byte] = std::move(byteEntry);
   }
 
   buildReverseTable();
@@ -74,7 +80,7 @@ void Table::decode(const Encoded& encodedTable, const uint8_t bitsPerCode)
 
 double Table::calculateEntropy() const
 {
-  int totalQuantity = 0;
+  uint64_t totalQuantity = 0;
   double entropy = 0.0f;
   for (const Pair<const uint8_t&, const ByteEntry&>& pair : table_)
   {
@@ -83,72 +89,127 @@ double Table::calculateEntropy() const
   for (const Pair<const uint8_t&, const ByteEntry&>& pair : table_)
   {
     const double freq = static_cast<double>(pair.second.occurrences) /
-      totalQuantity;
+      static_cast<double>(totalQuantity);
     entropy += freq * std::log2(freq);
   }
   return -1 * entropy;
 }
 
-const Encoded& Table::getCodeForByte(const uint8_t byte) const
+const Code& Table::getCodeForByte(const uint8_t byte) const
 {
   return table_[byte].code;
 }
 
-bool Table::getByteByCode(const Encoded& code, uint8_t& outByte) const
+bool Table::getByteByCode(const Code& code, uint8_t& outByte) const
 {
-  if (!reverseTable_.contains(code))
+  const uint64_t key = code.key();
+  if (!reverseTable_.contains(key))
     return false;
 
-  outByte = reverseTable_[code];
+  outByte = reverseTable_[key];
   return true;
 }
 
-const UnorderedMap<uint8_t, ByteEntry>& Table::getRawTable() const
+const ByteMap<ByteEntry>& Table::getRawTable() const
 {
   return table_;
 }
 
-void Table::countByteFrequencies(const Buffer& buffer)
+void Table::build(const uint8_t* bytes, const size_t size)
+{
+  size_t counts[SYMBOL_COUNT];
+  {
+    ProfileScope phase("histogram", size);
+    histogram(bytes, size, counts);
+  }
+
+  buildFromHistogram(counts);
+}
+
+void Table::histogram(const uint8_t* bytes, const size_t size, size_t* counts)
 {
-  for (const uint8_t byte : buffer)
+  // four interleaved tables, so runs of one byte value do not serialise on
+  // a single counter
+  size_t partial[4][SYMBOL_COUNT] = {};
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
   {
-    if (!table_.contains(byte))
-      table_[byte].byte = byte;
-    table_[byte].occurrences++;
+    partial[0][bytes[i]]++;
+    partial[1][bytes[i + 1]]++;
+    partial[2][bytes[i + 2]]++;
+    partial[3][bytes[i + 3]]++;
   }
+  for (; i < size; i++)
+    partial[0][bytes[i]]++;
+
+  for (size_t symbol = 0; symbol < SYMBOL_COUNT; symbol++)
+    counts[symbol] = partial[0][symbol] + partial[1][symbol] +
+      partial[2][symbol] + partial[3][symbol];
 }
 
-Vector<ByteEntry> Table::toVector() const
+Table Table::fromHistogram(const size_t* counts)
 {
-  Vector<ByteEntry> tableVector;
-  for (const Pair<uint8_t, ByteEntry> pair : table_)
+  Table table;
+  table.buildFromHistogram(counts);
+  return table;
+}
+
+void Table::buildFromHistogram(const size_t* counts)
+{
+  ProfileScope phase("build codes");
+  for (size_t symbol = 0; symbol < SYMBOL_COUNT; symbol++)
+    if (counts[symbol])
+      table_.insert(static_cast<uint8_t>(symbol),
+                    ByteEntry(static_cast<uint8_t>(symbol), counts[symbol]));
+  if (table_.empty())
+    throw TableException("Input is empty");
+
+  TableVector tableVector = toVector();
+  sortTableVectorByFrequency(tableVector);
+  buildFanoCodes(tableVector, 0, tableVector.size());
+  fromVector(tableVector);
+}
+
+Table::TableVector Table::toVector() const
+{
+  TableVector tableVector;
+  for (const Pair<const uint8_t&, const ByteEntry&> pair : table_)
     tableVector.pushBack(pair.second);
   return tableVector;
 }
 
-void Table::sortTableVectorByFrequency(Vector<ByteEntry>& tableVector)
+void Table::sortTableVectorByFrequency(TableVector& tableVector)
 {
-  for (int i = 0; i < tableVector.size() - 1; ++i)
-    for (int j = 0; j < tableVector.size() - i - 1; ++j)
+  if (tableVector.size() < 2)
+    return;
+
+  for (size_t i = 0; i < tableVector.size() - 1; ++i)
+    for (size_t j = 0; j < tableVector.size() - i - 1; ++j)
       if (tableVector[j].occurrences < tableVector[j + 1].occurrences)
         ByteEntry::swap(tableVector[j], tableVector[j + 1]);
 }
 
-void Table::buildFanoCodes(Vector<ByteEntry>& tableVector, const size_t start,
+void Table::buildFanoCodes(TableVector& tableVector, const size_t start,
                            const size_t end)
 {
+  // the loops below index without bounds checks in release builds
+  if (start >= end || end > tableVector.size())
+    throw TableException("Invalid code range");
+  if (tableVector[start].code.full())
+    throw TableException("Code is too long");
+
   if (end - start == 1)
   {
     tableVector[start].code.pushBack(false);
     return;
   }
 
-  size_t total = 0;
+  uint64_t total = 0;
   for (size_t i = start; i < end; i++)
     total += tableVector[i].occurrences;
 
   size_t split = start;
-  long long sum = tableVector[split].occurrences;
+  uint64_t sum = tableVector[split].occurrences;
 
   while (split < end && sum * 2 <= total)
   {
@@ -167,10 +228,10 @@ void Table::buildFanoCodes(Vector<ByteEntry>& tableVector, const size_t start,
   buildFanoCodes(tableVector, split, end);
 }
 
-void Table::fromVector(Vector<ByteEntry>& tableVector)
+void Table::fromVector(TableVector& tableVector)
 {
-  for (const ByteEntry& byteEntry : tableVector)
-    table_[byteEntry.byte] = byteEntry;
+  for (ByteEntry& byteEntry : tableVector)
+    table_[byteEntry.byte] = std::move(byteEntry);
 }
 
 size_t Table::findMaxCodeLength()
@@ -181,7 +242,7 @@ size_t Table::findMaxCodeLength()
   size_t max = 0;
 
   for (const Pair<const uint8_t&, const ByteEntry&> pair : table_)
-    max = std::max(max, pair.second.code.size());
+    max = std::max(max, static_cast<size_t>(pair.second.code.length));
 
   return max;
 }
@@ -189,5 +250,23 @@ size_t Table::findMaxCodeLength()
 void Table::buildReverseTable()
 {
   for (const Pair<const uint8_t&, ByteEntry&>& pair : table_)
-    reverseTable_[pair.second.code] = pair.first;
+    reverseTable_[pair.second.code.key()] = pair.first;
+}
+
+Code Table::parseNormalizedCode(const Encoded& bits, const size_t start,
+                                const size_t width)
+{
+  const size_t end = start + width;
+  size_t marker = start;
+  while (marker < end && !bits[marker])
+    marker++;
+
+  if (marker + 1 >= end)
+    throw FanoException("Incorrect code format");
+
+  const size_t length = end - marker - 1;
+  if (length > Code::MAX_LENGTH)
+    throw TableException("Code is too long");
+
+  return Code(bits.getBits(marker + 1, length), static_cast<uint8_t>(length));
 }
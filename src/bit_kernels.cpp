@@ -0,0 +1,240 @@
+#include "../include/bit_kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+  (defined(__GNUC__) || defined(__clang__))
+#define FANO_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FANO_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define FANO_ALWAYS_INLINE inline
+#endif
+
+using bit_kernels::CodeTable;
+using bit_kernels::Isa;
+using bit_kernels::Kernels;
+
+namespace
+{
+  constexpr size_t BITS_PER_WORD = 64;
+
+  // Output state of an encode loop: the word being filled and how many of
+  // its low bits are valid.
+  struct BitSink
+  {
+    uint64_t* out;
+    uint64_t accumulator;
+    size_t used;
+  };
+
+  FANO_ALWAYS_INLINE BitSink openSink(uint64_t* words,
+                                      const size_t bitPosition)
+  {
+    BitSink sink;
+    sink.out = words + bitPosition / BITS_PER_WORD;
+    sink.used = bitPosition % BITS_PER_WORD;
+    sink.accumulator = sink.used
+                         ? *sink.out & ((uint64_t{1} << sink.used) - 1)
+                         : 0;
+    return sink;
+  }
+
+  // Adds `length` (1..64) bits, storing the word once it is complete.
+  FANO_ALWAYS_INLINE void put(BitSink& sink, const uint64_t bits,
+                              const size_t length)
+  {
+    sink.accumulator |= bits << sink.used;
+    sink.used += length;
+    if (sink.used >= BITS_PER_WORD)
+    {
+      *sink.out++ = sink.accumulator;
+      sink.used -= BITS_PER_WORD;
+      // the bits that did not fit; `length - used` is below 64 here
+      sink.accumulator = sink.used ? bits >> (length - sink.used) : 0;
+    }
+  }
+
+  FANO_ALWAYS_INLINE void closeSink(const BitSink& sink, uint64_t* words,
+                                    size_t& bitPosition)
+  {
+    if (sink.used)
+      *sink.out = sink.accumulator;
+    bitPosition = static_cast<size_t>(sink.out - words) * BITS_PER_WORD +
+      sink.used;
+  }
+
+  // One code per step: the scalar variant, and the tail of the AVX2 one.
+  FANO_ALWAYS_INLINE size_t encodeOneByOne(
+    const uint8_t* symbols, const size_t count, const CodeTable& codes,
+    uint64_t* words, size_t& bitPosition)
+  {
+    BitSink sink = openSink(words, bitPosition);
+    size_t i = 0;
+    for (; i < count; i++)
+    {
+      const size_t length = codes.lengths[symbols[i]];
+      if (length == 0)
+        break;
+      put(sink, codes.bits[symbols[i]], length);
+    }
+    closeSink(sink, words, bitPosition);
+    return i;
+  }
+
+  size_t encodeScalar(const uint8_t* symbols, const size_t count,
+                      const CodeTable& codes, uint64_t* words,
+                      size_t& bitPosition)
+  {
+    return encodeOneByOne(symbols, count, codes, words, bitPosition);
+  }
+
+#ifdef FANO_X86_KERNELS
+  // Four codes per step: their offsets inside the group are prefix sums of
+  // the lengths, one vpsllvq shifts all four into place and an OR
+  // reduction joins them, so the serial accumulator update runs once per
+  // four symbols. A group longer than 64 bits, or containing a byte with
+  // no code, is written one code at a time before the next group.
+  __attribute__((target("avx2,bmi2")))
+  size_t encodeAvx2(const uint8_t* symbols, const size_t count,
+                    const CodeTable& codes, uint64_t* words,
+                    size_t& bitPosition)
+  {
+    BitSink sink = openSink(words, bitPosition);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const size_t l0 = codes.lengths[symbols[i]];
+      const size_t l1 = codes.lengths[symbols[i + 1]];
+      const size_t l2 = codes.lengths[symbols[i + 2]];
+      const size_t l3 = codes.lengths[symbols[i + 3]];
+      const size_t total = l0 + l1 + l2 + l3;
+      if (total > BITS_PER_WORD || !l0 || !l1 || !l2 || !l3)
+      {
+        for (size_t j = i; j < i + 4; j++)
+        {
+          const size_t length = codes.lengths[symbols[j]];
+          if (length == 0)
+          {
+            closeSink(sink, words, bitPosition);
+            return j;
+          }
+          put(sink, codes.bits[symbols[j]], length);
+        }
+        continue;
+      }
+
+      const __m256i bits = _mm256_set_epi64x(
+        static_cast<long long>(codes.bits[symbols[i + 3]]),
+        static_cast<long long>(codes.bits[symbols[i + 2]]),
+        static_cast<long long>(codes.bits[symbols[i + 1]]),
+        static_cast<long long>(codes.bits[symbols[i]]));
+      const __m256i offsets = _mm256_set_epi64x(
+        static_cast<long long>(l0 + l1 + l2),
+        static_cast<long long>(l0 + l1), static_cast<long long>(l0), 0);
+      const __m256i shifted = _mm256_sllv_epi64(bits, offsets);
+      __m128i merged = _mm_or_si128(_mm256_castsi256_si128(shifted),
+                                    _mm256_extracti128_si256(shifted, 1));
+      merged = _mm_or_si128(merged, _mm_unpackhi_epi64(merged, merged));
+      put(sink, static_cast<uint64_t>(_mm_cvtsi128_si64(merged)), total);
+    }
+    closeSink(sink, words, bitPosition);
+
+    // the last few symbols
+    return i + encodeOneByOne(symbols + i, count - i, codes, words,
+                              bitPosition);
+  }
+#endif
+
+  const Kernels SCALAR_KERNELS = {Isa::SCALAR, encodeScalar};
+#ifdef FANO_X86_KERNELS
+  const Kernels AVX2_KERNELS = {Isa::AVX2, encodeAvx2};
+#endif
+
+  const Kernels* kernelsFor(const Isa isa)
+  {
+    switch (isa)
+    {
+#ifdef FANO_X86_KERNELS
+    case Isa::AVX2:
+      return &AVX2_KERNELS;
+#endif
+    default:
+      return &SCALAR_KERNELS;
+    }
+  }
+
+  const Kernels* detect()
+  {
+    // best first
+    const Isa candidates[] = {Isa::AVX2, Isa::SCALAR};
+
+    const char* forced = std::getenv("FANO_KERNELS");
+    if (forced)
+      for (const Isa isa : candidates)
+        if (std::strcmp(forced, bit_kernels::name(isa)) == 0 &&
+          bit_kernels::supported(isa))
+          return kernelsFor(isa);
+
+    for (const Isa isa : candidates)
+      if (bit_kernels::supported(isa))
+        return kernelsFor(isa);
+    return &SCALAR_KERNELS;
+  }
+
+  const Kernels*& selected()
+  {
+    static const Kernels* kernels = detect();
+    return kernels;
+  }
+
+  // Resolved during static initialisation, so the CPU is probed at startup
+  // rather than inside the first encode.
+  const Kernels* const STARTUP_KERNELS = selected();
+}
+
+const char* bit_kernels::name(const Isa isa)
+{
+  switch (isa)
+  {
+  case Isa::SCALAR:
+    return "scalar";
+  case Isa::AVX2:
+    return "avx2";
+  }
+  return "unknown";
+}
+
+bool bit_kernels::supported(const Isa isa)
+{
+  switch (isa)
+  {
+  case Isa::SCALAR:
+    return true;
+#ifdef FANO_X86_KERNELS
+  case Isa::AVX2:
+    // may run from a static initialiser, before libgcc has probed the CPU
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+#endif
+  default:
+    return false;
+  }
+}
+
+const Kernels& bit_kernels::active()
+{
+  return *selected();
+}
+
+bool bit_kernels::select(const Isa isa)
+{
+  if (!supported(isa))
+    return false;
+  selected() = kernelsFor(isa);
+  return true;
+}
@@ -16,11 +16,7 @@ void bit_utils::printBits(const Vector<bool>& bits, const size_t lineWidth)
 Vector<bool> bit_utils::byteToBits(const uint8_t byte)
 {
   Vector<bool> bits;
-  for (int i = 0; i < BITS_IN_BYTE; i++)
-  {
-    bool bit = byte >> i & 1;
-    bits.pushBack(bit);
-  }
+  bits.appendBits(byte, BITS_IN_BYTE);
   return bits;
 }
 
@@ -29,30 +25,13 @@ uint8_t bit_utils::bitsToByte(const Vector<bool>& bits)
   if (bits.size() > BITS_IN_BYTE)
     throw FanoException("bitsToByte: size exceeds 8 bits");
 
-  uint8_t result = 0;
-  for (size_t i = 0; i < bits.size(); i++)
-    if (bits[i])
-      result |= static_cast<uint8_t>(1 << i);
-
-  return result;
+  return static_cast<uint8_t>(bits.getBits(0, bits.size()));
 }
 
 Vector<uint8_t> bit_utils::packBits(const Vector<bool>& bits)
 {
   Vector<uint8_t> bytes((bits.size() + 7) / BITS_IN_BYTE, 0);
-
-  size_t bitIndex = 0;
-  for (auto const& bit : bits)
-  {
-    if (bit)
-    {
-      const size_t byteIndex = bitIndex >> 3;
-      const uint8_t mask = static_cast<uint8_t>(1) << (bitIndex & 7);
-      bytes[byteIndex] |= mask;
-    }
-    bitIndex++;
-  }
-
+  bits.toBytes(bytes.data());
   return bytes;
 }
 
@@ -70,20 +49,17 @@ Vector<bool> bit_utils::processCodeBuffer(const Vector<bool>& buffer)
   if (startIndex == NOT_FOUND || startIndex >= static_cast<int>(buffer.size()))
     throw FanoException("Incorrect code format");
 
-  Vector<bool> processedBuffer;
-  for (size_t i = startIndex; i < buffer.size(); i++)
-    processedBuffer.pushBack(buffer[i]);
-
-  return processedBuffer;
+  return Vector<bool>(buffer.begin() + startIndex, buffer.end());
 }
 
 Vector<bool> bit_utils::addLeadingZerosToCode(const Vector<bool>& code,
                                               const size_t length)
 {
-  Vector<bool> result(length, false);
-  for (int i = 1; i <= code.size(); i++)
-    result[length - i] = code[code.size() - i];
+  if (code.size() > length)
+    throw FanoException("Code is longer than the requested length");
 
+  Vector<bool> result(length - code.size(), false);
+  result += code;
   return result;
 }
 
@@ -97,11 +73,5 @@ Vector<bool> bit_utils::normalizeCode(const Vector<bool>& code,
 
 Vector<bool> bit_utils::byteBufferToBits(const Vector<uint8_t>& buffer)
 {
-  Vector<bool> bits;
-
-  for (const uint8_t byte : buffer)
-    for (int i = 0; i < BITS_IN_BYTE; i++)
-      bits.pushBack(byte >> i & 1);
-
-  return bits;
+  return Vector<bool>::fromBytes(buffer.data(), buffer.size());
 }
@@ -1,7 +1,15 @@
 #include "../include/file_io.h"
 
+#include <cstdio>
 #include <fstream>
 
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 void file_io::checkFiles(const String& inputFilePath,
                          const String& outputFilePath)
 {
@@ -25,7 +33,8 @@ Buffer file_io::readFileToBuffer(const String& inputFile)
   if (fileSize < 0)
     throw FileException("Negative file size is invalid");
 
-  Buffer buffer(static_cast<size_t>(fileSize), 0);
+  Buffer buffer;
+  buffer.resizeUninitialized(static_cast<size_t>(fileSize));
   if (!ifs.read(reinterpret_cast<char*>(buffer.data()), fileSize))
   {
     throw FileException("Failed to read file data");
@@ -54,3 +63,132 @@ size_t file_io::getFileSize(const String& filePath)
                      std::ios::binary | std::ios::ate);
   return file.tellg();
 }
+
+file_io::OutputFile::OutputFile(const String& path, const size_t size,
+                                const bool map) :
+  path_(path), size_(size), descriptor_(-1), mapping_(nullptr),
+  committed_(false)
+{
+#ifdef __linux__
+  openTemporary();
+
+  if (size_ != 0)
+  {
+    // file systems without fallocate still take a plain resize
+    const int error = ::posix_fallocate(descriptor_, 0,
+                                        static_cast<off_t>(size_));
+    if (error != 0 && ((error != EOPNOTSUPP && error != EINVAL) ||
+      ::ftruncate(descriptor_, static_cast<off_t>(size_)) != 0))
+    {
+      close();
+      ::unlink(temporaryPath_.c_str());
+      throw FileException("Cannot allocate the output file");
+    }
+  }
+
+  if (map && size_ != 0)
+  {
+    void* mapping = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, descriptor_, 0);
+    if (mapping != MAP_FAILED)
+      mapping_ = static_cast<uint8_t*>(mapping);
+  }
+#else
+  static_cast<void>(map);
+#endif
+
+  if (mapping_ == nullptr)
+    buffer_.resizeUninitialized(size_);
+}
+
+file_io::OutputFile::~OutputFile()
+{
+  close();
+  // a failed decode leaves no partial file behind, and whatever was at
+  // path_ before is still there
+#ifdef __linux__
+  if (!committed_)
+    ::unlink(temporaryPath_.c_str());
+#endif
+}
+
+uint8_t* file_io::OutputFile::data()
+{
+  return mapping_ ? mapping_ : buffer_.data();
+}
+
+size_t file_io::OutputFile::size() const
+{
+  return size_;
+}
+
+bool file_io::OutputFile::mapped() const
+{
+  return mapping_ != nullptr;
+}
+
+void file_io::OutputFile::commit()
+{
+  if (committed_)
+    throw FileException("Output file is already committed");
+
+#ifdef __linux__
+  // a mapped file is written back by the kernel
+  size_t written = 0;
+  while (mapping_ == nullptr && written < size_)
+  {
+    const ssize_t result = ::write(descriptor_, buffer_.data() + written,
+                                   size_ - written);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      throw FileException("Failed to write the output file");
+    written += static_cast<size_t>(result);
+  }
+  close();
+  if (::rename(temporaryPath_.c_str(), path_.c_str()) != 0)
+    throw FileException("Cannot replace the output file");
+#else
+  writeToFile(path_, buffer_);
+#endif
+  committed_ = true;
+}
+
+void file_io::OutputFile::openTemporary()
+{
+#ifdef __linux__
+  // path_.tmp, or path_.1.tmp and so on if that is taken; O_EXCL keeps an
+  // unrelated file of the same name safe
+  Vector<char> name(path_.size() + 32, '\0');
+  for (unsigned attempt = 0; attempt < 100; attempt++)
+  {
+    if (attempt == 0)
+      std::snprintf(name.data(), name.size(), "%s.tmp", path_.c_str());
+    else
+      std::snprintf(name.data(), name.size(), "%s.%u.tmp", path_.c_str(),
+                    attempt);
+    // 0666 so the umask decides, as for any newly created file
+    descriptor_ = ::open(name.data(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (descriptor_ >= 0)
+    {
+      temporaryPath_ = String(name.data());
+      return;
+    }
+    if (errno != EEXIST)
+      break;
+  }
+  throw FileException("Cannot open the output file");
+#endif
+}
+
+void file_io::OutputFile::close()
+{
+#ifdef __linux__
+  if (mapping_)
+    ::munmap(mapping_, size_);
+  mapping_ = nullptr;
+  if (descriptor_ >= 0)
+    ::close(descriptor_);
+  descriptor_ = -1;
+#endif
+}
@@ -0,0 +1,134 @@
+#include "../include/Arena.h"
+#include "../include/Encoder.h"
+#include "../include/String.h"
+#include "../include/UnorderedMap.h"
+#include "../include/Vector.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace ArenaTests {
+
+    class CountingResource : public MemoryResource {
+    public:
+        size_t allocations = 0;
+        size_t live = 0;
+
+        void *allocate(size_t bytes, size_t) override {
+            allocations++;
+            live++;
+            return ::operator new(bytes);
+        }
+
+        void deallocate(void *pointer, size_t, size_t) override {
+            live--;
+            ::operator delete(pointer);
+        }
+    };
+
+    void testAllocationsAreAlignedAndBumped() {
+        Arena arena(256);
+        void *a = arena.allocate(3, 1);
+        void *b = arena.allocate(8, 8);
+        void *c = arena.allocate(1000, 16);
+        assert(reinterpret_cast<uintptr_t>(b) % 8 == 0);
+        assert(reinterpret_cast<uintptr_t>(c) % 16 == 0);
+        assert(static_cast<char *>(b) > static_cast<char *>(a));
+        assert(arena.chunkCount() == 2);
+
+        arena.deallocate(c, 1000, 16);
+        assert(arena.allocate(1000, 16) == c);
+    }
+
+    void testPaddingPastChunkEndGetsNewSpace() {
+        Arena arena;
+        // odd-sized first chunk: the 8-byte alignment of the next request
+        // would start it past the chunk's end
+        auto *a = static_cast<char *>(arena.allocate(100001, 1));
+        auto *b = static_cast<char *>(arena.allocate(8, 8));
+        auto *c = static_cast<char *>(arena.allocate(16, 16));
+        assert(reinterpret_cast<uintptr_t>(b) % 8 == 0);
+        assert(reinterpret_cast<uintptr_t>(c) % 16 == 0);
+        std::memset(a, 1, 100001);
+        std::memset(b, 2, 8);
+        std::memset(c, 3, 16);
+        assert(a[100000] == 1 && b[7] == 2 && c[15] == 3);
+    }
+
+    void testDefaultResourceHonoursAlignment() {
+        MemoryResource *resource = MemoryResource::defaultResource();
+        const size_t alignments[] = {1, 16, 64, 4096};
+        for (size_t alignment : alignments) {
+            void *pointer = resource->allocate(100, alignment);
+            assert(reinterpret_cast<uintptr_t>(pointer) % alignment == 0);
+            std::memset(pointer, 0, 100);
+            resource->deallocate(pointer, 100, alignment);
+        }
+    }
+
+    void testContainersUseCurrentResource() {
+        Arena arena;
+        Vector<int> outside;
+        {
+            MemoryResourceScope scope(&arena);
+            Vector<int> inside;
+            UnorderedMap<int, int> map;
+            String string("arena");
+            assert(inside.resource() == &arena);
+            assert(Vector<bool>().resource() == &arena);
+            for (int i = 0; i < 100; ++i) {
+                inside.pushBack(i);
+                map[i] = i;
+            }
+
+            // storage stays with its resource; the elements move over
+            outside = std::move(inside);
+            assert(string == "arena");
+        }
+        arena.release();
+
+        assert(outside.resource() == MemoryResource::defaultResource());
+        assert(outside.size() == 100 && outside[99] == 99);
+    }
+
+    void testResetStopsUpstreamAllocations() {
+        CountingResource upstream;
+        Arena arena(1024, &upstream);
+        uint8_t input[4096];
+        for (size_t i = 0; i < sizeof(input); ++i)
+            input[i] = static_cast<uint8_t>(i * 7 % 13);
+
+        Packed first;
+        Packed output;
+        size_t steadyAllocations = 0;
+        for (int cycle = 0; cycle < 3; ++cycle) {
+            {
+                MemoryResourceScope scope(&arena);
+                Encoder::encode(input, sizeof(input), output);
+            }
+            arena.reset();
+            if (cycle == 0) {
+                first = output;
+                steadyAllocations = upstream.allocations;
+            }
+            assert(output == first);
+            assert(upstream.allocations == steadyAllocations);
+        }
+        assert(arena.chunkCount() == 1);
+        arena.release();
+        assert(upstream.live == 0);
+    }
+
+    void runArenaTest() {
+        std::cout << "[ArenaTest] Running...\n";
+        testAllocationsAreAlignedAndBumped();
+        testPaddingPastChunkEndGetsNewSpace();
+        testDefaultResourceHonoursAlignment();
+        testContainersUseCurrentResource();
+        testResetStopsUpstreamAllocations();
+        std::cout << "[ArenaTest] All tests passed\n";
+    }
+
+}
@@ -0,0 +1,129 @@
+#include "../include/bit_kernels.h"
+#include "../include/bit_utils.h"
+#include "../include/Data.h"
+#include "../include/Table.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace BitKernelsTests {
+
+    const bit_kernels::Isa ALL_ISAS[] = {
+        bit_kernels::Isa::SCALAR, bit_kernels::Isa::AVX2
+    };
+
+    uint64_t nextRandom(uint64_t &state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // Codes of random length up to `maxLength`; `missing` gets no code.
+    bit_kernels::CodeTable randomCodes(uint64_t &state, size_t maxLength,
+                                       int missing) {
+        bit_kernels::CodeTable codes = {};
+        for (int symbol = 0; symbol < 256; symbol++) {
+            if (symbol == missing)
+                continue;
+            const size_t length = 1 + nextRandom(state) % maxLength;
+            codes.lengths[symbol] = static_cast<uint8_t>(length);
+            codes.bits[symbol] = nextRandom(state) &
+                    ((uint64_t{1} << length) - 1);
+        }
+        return codes;
+    }
+
+    void testVariantsMatchScalar() {
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        uint8_t symbols[1000];
+        for (uint8_t &symbol : symbols)
+            symbol = static_cast<uint8_t>(nextRandom(state));
+
+        for (const size_t maxLength : {4, 16, 40, 63}) {
+            const bit_kernels::CodeTable codes =
+                    randomCodes(state, maxLength, -1);
+            for (const size_t offset : {0, 5, 63, 64}) {
+                uint64_t expected[1000] = {};
+                expected[0] = ~uint64_t{0};
+                expected[1] = ~uint64_t{0};
+                size_t expectedEnd = offset;
+                bit_kernels::select(bit_kernels::Isa::SCALAR);
+                assert(bit_kernels::active().encodeSymbols(
+                        symbols, 1000, codes, expected, expectedEnd) == 1000);
+
+                for (const bit_kernels::Isa isa : ALL_ISAS) {
+                    if (!bit_kernels::select(isa))
+                        continue;
+                    uint64_t words[1000] = {};
+                    words[0] = ~uint64_t{0};
+                    words[1] = ~uint64_t{0};
+                    size_t end = offset;
+                    assert(bit_kernels::active().encodeSymbols(
+                            symbols, 1000, codes, words, end) == 1000);
+                    assert(end == expectedEnd);
+                    assert(std::memcmp(words, expected,
+                                       (end + 63) / 64 * 8) == 0);
+                }
+            }
+        }
+    }
+
+    void testStopsAtByteWithoutCode() {
+        const uint8_t symbols[] = "abcdefghijklmnopqrstuvwxyz";
+        // inside a four-symbol group and in the tail after the last one
+        const char missingBytes[] = {'b', 'k', 'z'};
+        for (const char missing : missingBytes) {
+            uint64_t state = 42;
+            const bit_kernels::CodeTable codes =
+                    randomCodes(state, 12, missing);
+            const size_t stop = static_cast<size_t>(missing - 'a');
+
+            for (const bit_kernels::Isa isa : ALL_ISAS) {
+                if (!bit_kernels::select(isa))
+                    continue;
+                uint64_t words[16] = {};
+                size_t end = 0;
+                assert(bit_kernels::active().encodeSymbols(
+                        symbols, 26, codes, words, end) == stop);
+                size_t expectedEnd = 0;
+                for (size_t i = 0; i < stop; i++)
+                    expectedEnd += codes.lengths[symbols[i]];
+                assert(end == expectedEnd);
+            }
+        }
+    }
+
+    void testEncodedDataIsIdenticalAcrossVariants() {
+        const char *text = "the quick brown fox jumps over the lazy dog "
+                "while the five boxing wizards jump quickly";
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(text);
+        const size_t size = std::strlen(text);
+        const Table table(bytes, size);
+
+        bit_kernels::select(bit_kernels::Isa::SCALAR);
+        const Packed expected =
+                bit_utils::packBits(Data::encode(table, bytes, size));
+        for (const bit_kernels::Isa isa : ALL_ISAS) {
+            if (!bit_kernels::select(isa))
+                continue;
+            const Packed packed =
+                    bit_utils::packBits(Data::encode(table, bytes, size));
+            assert(packed.size() == expected.size());
+            assert(std::memcmp(packed.data(), expected.data(),
+                               packed.size()) == 0);
+        }
+    }
+
+    void runBitKernelsTest() {
+        std::cout << "[BitKernelsTest] Running...\n";
+        const bit_kernels::Isa original = bit_kernels::active().isa;
+        testVariantsMatchScalar();
+        testStopsAtByteWithoutCode();
+        testEncodedDataIsIdenticalAcrossVariants();
+        bit_kernels::select(original);
+        std::cout << "[BitKernelsTest] All tests passed\n";
+    }
+
+}
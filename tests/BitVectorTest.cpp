@@ -0,0 +1,112 @@
+#include "../include/BitVector.h"
+#include <cassert>
+#include <iostream>
+
+namespace BitVectorTests {
+
+    void testAppendAcrossWordBoundary() {
+        BitVector bits;
+        bits.appendBits(0, 60);
+        bits.appendBits(0b101101, 6);
+        assert(bits.size() == 66);
+        assert(bits.wordCount() == 2);
+        assert(bits.getBits(60, 6) == 0b101101);
+        assert(bits[60] == true);
+        assert(bits[61] == false);
+        assert(bits[65] == true);
+    }
+
+    void testIndexAssignment() {
+        BitVector bits(70, false);
+        bits[3] = true;
+        bits[69] = true;
+        assert(bits[3]);
+        assert(bits[69]);
+        bits[3] = false;
+        assert(!bits[3]);
+    }
+
+    void testPlusEqualsUnaligned() {
+        BitVector a;
+        a.appendBits(0b1, 1);
+        BitVector b;
+        for (int i = 0; i < 130; i++)
+            b.pushBack(i % 3 == 0);
+
+        a += b;
+        assert(a.size() == 131);
+        assert(a[0]);
+        for (size_t i = 0; i < b.size(); i++)
+            assert(a[i + 1] == b[i]);
+    }
+
+    void testEqualityAndHashIgnoreStaleBits() {
+        BitVector a;
+        a.appendBits(0xFF, 8);
+        a.popBack();
+        a.popBack();
+
+        BitVector b;
+        b.appendBits(0x3F, 6);
+
+        assert(a == b);
+        assert(a.hash() == b.hash());
+
+        BitVector c;
+        c.appendBits(0x3F, 7);
+        assert(a != c);
+    }
+
+    void testBytesRoundTrip() {
+        uint8_t bytes[11];
+        for (uint8_t i = 0; i < sizeof(bytes); i++)
+            bytes[i] = static_cast<uint8_t>(i * 37 + 1);
+
+        const BitVector bits = BitVector::fromBytes(bytes, sizeof(bytes));
+        assert(bits.size() == sizeof(bytes) * 8);
+
+        uint8_t restored[sizeof(bytes)];
+        bits.toBytes(restored);
+        for (size_t i = 0; i < sizeof(bytes); i++)
+            assert(restored[i] == bytes[i]);
+    }
+
+    void testRangeConstructor() {
+        BitVector bits;
+        for (int i = 0; i < 200; i++)
+            bits.pushBack(i % 7 == 0);
+
+        const BitVector slice(bits.begin() + 5, bits.begin() + 150);
+        assert(slice.size() == 145);
+        for (size_t i = 0; i < slice.size(); i++)
+            assert(slice[i] == bits[i + 5]);
+    }
+
+    void testShortVectorsStayInline() {
+        BitVector code;
+        code.appendBits(0x5, 40);
+        assert(code.isInline());
+
+        BitVector copy(code);
+        assert(copy.isInline());
+        assert(copy == code);
+
+        code.pushBack(true);
+        code.appendBits(0, 30);
+        assert(!code.isInline());
+        assert(code.getBits(0, 41) == (0x5ull | 1ull << 40));
+    }
+
+    void runBitVectorTest() {
+        std::cout << "[BitVectorTest] Running...\n";
+        testAppendAcrossWordBoundary();
+        testIndexAssignment();
+        testPlusEqualsUnaligned();
+        testEqualityAndHashIgnoreStaleBits();
+        testBytesRoundTrip();
+        testRangeConstructor();
+        testShortVectorsStayInline();
+        std::cout << "[BitVectorTest] All tests passed\n";
+    }
+
+}
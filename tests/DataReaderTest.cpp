@@ -0,0 +1,142 @@
+#include "../include/Decoder.h"
+#include "../include/Encoder.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+namespace DataReaderTests {
+
+    void testReadInSmallSpans() {
+        const char text[] = "lazy decoding hands out bytes on demand";
+        const auto *input = reinterpret_cast<const uint8_t *>(text);
+        const size_t size = sizeof(text) - 1;
+
+        Packed encoded;
+        Encoder::encode(input, size, encoded);
+        DataReader reader = Decoder::openReader(encoded.data(), encoded.size());
+
+        Buffer decoded;
+        uint8_t span[3];
+        size_t produced;
+        while ((produced = reader.read(span, sizeof(span))) != 0) {
+            assert(produced <= sizeof(span));
+            for (size_t i = 0; i < produced; ++i)
+                decoded.pushBack(span[i]);
+        }
+
+        assert(reader.atEnd());
+        assert(decoded.size() == size);
+        for (size_t i = 0; i < size; ++i)
+            assert(decoded[i] == input[i]);
+    }
+
+    void testReadThrowsOnLeftoverBits() {
+        Buffer buffer;
+        buffer.pushBack('x');
+        buffer.pushBack('y');
+
+        Table table(buffer);
+        Data data(buffer);
+        Encoded encoded = data.encode(table);
+        encoded.pushBack(true);
+        const Packed packed = bit_utils::packBits(encoded);
+
+        DataReader reader(table, packed.data(), 0, encoded.size());
+        uint8_t span[8];
+        bool caught = false;
+        try {
+            reader.read(span, sizeof(span));
+        } catch (const DataException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    // Symbol i occurs 2^(i-1) times (symbol 0 once), which gives codes up
+    // to symbolCount bits long; the bytes are shuffled so short
+    // and long codes interleave.
+    Buffer skewedInput(size_t symbolCount) {
+        Buffer input;
+        input.pushBack('A');
+        for (size_t i = 1; i < symbolCount; i++)
+            for (size_t n = 0; n < size_t{1} << (i - 1); n++)
+                input.pushBack(static_cast<uint8_t>('A' + i));
+
+        uint64_t state = 88172645463325252ULL;
+        for (size_t i = input.size() - 1; i > 0; i--) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            const size_t j = state % (i + 1);
+            const uint8_t swapped = input[i];
+            input[i] = input[j];
+            input[j] = swapped;
+        }
+        return input;
+    }
+
+    void testEveryKernelWidthRoundTrips() {
+        // longest code -> expected lookup width; 20 exercises the slow path
+        const size_t cases[][2] = {
+            {5, 8}, {11, 11}, {12, 12}, {14, 15}, {16, 16}, {20, 16}
+        };
+        for (const auto &testCase : cases) {
+            const Buffer input = skewedInput(testCase[0]);
+            Packed encoded;
+            Encoder::encode(input.data(), input.size(), encoded);
+
+            DataReader reader =
+                    Decoder::openReader(encoded.data(), encoded.size());
+            assert(reader.width() == testCase[1]);
+
+            Buffer decoded;
+            uint8_t span[7];
+            size_t produced;
+            while ((produced = reader.read(span, sizeof(span))) != 0)
+                for (size_t i = 0; i < produced; ++i)
+                    decoded.pushBack(span[i]);
+
+            assert(decoded.size() == input.size());
+            for (size_t i = 0; i < input.size(); ++i)
+                assert(decoded[i] == input[i]);
+        }
+    }
+
+    void testBitsMatchingNoCodeThrow() {
+        Buffer buffer;
+        buffer.pushBack('a');
+        const Table table(buffer);
+
+        // the only code is "0", so a run of ones never decodes: it is an
+        // unknown code once it exceeds the longest possible code and
+        // leftover bits if the stream ends first
+        const uint8_t ones[16] = {
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+            0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+        };
+        uint8_t span[8];
+        const char *messages[2] = {"Unknown code", "Leftover bits"};
+        const size_t bitCounts[2] = {100, 10};
+        for (size_t i = 0; i < 2; ++i) {
+            DataReader reader(table, ones, 0, bitCounts[i]);
+            bool caught = false;
+            try {
+                reader.read(span, sizeof(span));
+            } catch (const DataException &ex) {
+                caught = std::string(ex.what()).find(messages[i]) !=
+                        std::string::npos;
+            }
+            assert(caught);
+        }
+    }
+
+    void runDataReaderTest() {
+        std::cout << "[DataReaderTest] Running...\n";
+        testReadInSmallSpans();
+        testReadThrowsOnLeftoverBits();
+        testEveryKernelWidthRoundTrips();
+        testBitsMatchingNoCodeThrow();
+        std::cout << "[DataReaderTest] All tests passed\n";
+    }
+
+}
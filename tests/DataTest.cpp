@@ -2,9 +2,14 @@
 #include "../include/Table.h"
 #include <cassert>
 #include <iostream>
+#include <type_traits>
 
 namespace DataTests {
 
+    // its buffer may have to be reallocated in the target's resource
+    static_assert(!std::is_nothrow_move_assignable<Data>::value,
+                  "Data move assignment may allocate");
+
     void testDataConstructorThrowsOnEmpty() {
         bool caught = false;
         try {
@@ -37,10 +42,41 @@ namespace DataTests {
         assert(caught);
     }
 
+    void testSyncOffsetsMatchPrefixLengths() {
+        Buffer buffer;
+        for (size_t i = 0; i < 1000; i++)
+            buffer.pushBack(static_cast<uint8_t>('a' + i * i % 7));
+        const Table table(buffer);
+
+        const size_t interval = 64;
+        const size_t streamCounts[] = {1, 4};
+        for (size_t streamCount : streamCounts) {
+            Vector<uint64_t> offsets;
+            const Vector<Encoded> streams = Data::encodeStreams(
+                    table, buffer.data(), buffer.size(), streamCount,
+                    interval, &offsets);
+
+            const size_t pointCount =
+                    (buffer.size() - 1) / (interval * streamCount);
+            assert(offsets.size() == pointCount * streamCount);
+            for (size_t point = 0; point < pointCount; point++)
+                for (size_t stream = 0; stream < streamCount; stream++) {
+                    // bits of the stream's first (point + 1) * interval codes
+                    uint64_t bits = 0;
+                    for (size_t n = 0; n < (point + 1) * interval; n++)
+                        bits += table.getCodeForByte(
+                                buffer[n * streamCount + stream]).length;
+                    assert(offsets[point * streamCount + stream] == bits);
+                    assert(bits <= streams[stream].size());
+                }
+        }
+    }
+
     void runDataTest() {
         std::cout << "[DataTest] Running...\n";
         testDataConstructorThrowsOnEmpty();
         testDecodeWithCorruptedDataThrows();
+        testSyncOffsetsMatchPrefixLengths();
         std::cout << "[DataTest] All tests passed\n";
     }
 
@@ -0,0 +1,76 @@
+#include "../include/DecoderContext.h"
+#include "../include/EncoderContext.h"
+#include <cassert>
+#include <iostream>
+
+namespace DecoderContextTests {
+
+    Buffer makeInput() {
+        Buffer input;
+        for (int i = 0; i < 1000; ++i)
+            input.pushBack(static_cast<uint8_t>("incremental"[i % 11]));
+        return input;
+    }
+
+    void testRoundTripInPieces() {
+        const Buffer input = makeInput();
+        EncoderContext encoder(64);
+        Packed encoded;
+        for (size_t i = 0; i < input.size(); i += 7) {
+            const size_t n = std::min<size_t>(7, input.size() - i);
+            encoder.update(input.data() + i, n, encoded);
+        }
+        encoder.finish(encoded);
+
+        DecoderContext decoder;
+        Buffer decoded;
+        for (size_t i = 0; i < encoded.size(); ++i)
+            decoder.update(encoded.data() + i, 1, decoded);
+        decoder.finish();
+
+        assert(decoded == input);
+    }
+
+    void testRoundTripInOneCall() {
+        const Buffer input = makeInput();
+        EncoderContext encoder(100);
+        Packed encoded;
+        encoder.update(input.data(), input.size(), encoded);
+        encoder.finish(encoded);
+
+        DecoderContext decoder;
+        Buffer decoded;
+        decoder.update(encoded.data(), encoded.size(), decoded);
+        decoder.finish();
+
+        assert(decoded == input);
+    }
+
+    void testFinishThrowsOnPartialFrame() {
+        const Buffer input = makeInput();
+        EncoderContext encoder;
+        Packed encoded;
+        encoder.update(input.data(), input.size(), encoded);
+        encoder.finish(encoded);
+
+        DecoderContext decoder;
+        Buffer decoded;
+        decoder.update(encoded.data(), encoded.size() - 1, decoded);
+        bool caught = false;
+        try {
+            decoder.finish();
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    void runDecoderContextTest() {
+        std::cout << "[DecoderContextTest] Running...\n";
+        testRoundTripInPieces();
+        testRoundTripInOneCall();
+        testFinishThrowsOnPartialFrame();
+        std::cout << "[DecoderContextTest] All tests passed\n";
+    }
+
+}
@@ -4,6 +4,8 @@
 #include <cassert>
 #include <iostream>
 #include <cstdio> // std::remove
+#include <new>
+#include <thread>
 
 namespace DecoderTests {
     void testDecoderWorksCorrectly() {
@@ -32,9 +34,519 @@ namespace DecoderTests {
         std::remove(outputFile.c_str());
     }
 
+    void testDecodeInMemoryRoundTrip() {
+        const char text[] = "in-memory round trip, no temp files";
+        const auto *input = reinterpret_cast<const uint8_t *>(text);
+        const size_t size = sizeof(text) - 1;
+
+        Packed encoded;
+        Encoder::encode(input, size, encoded);
+
+        Buffer decoded;
+        Decoder::decode(encoded.data(), encoded.size(), decoded);
+
+        assert(decoded.size() == size);
+        for (size_t i = 0; i < size; ++i)
+            assert(decoded[i] == input[i]);
+    }
+
+    void testDecodeInMemoryThrowsOnTruncatedInput() {
+        const uint8_t input[] = {0, 200, 9, 0};
+        Buffer decoded;
+        bool caught = false;
+        try {
+            Decoder::decode(input, sizeof(input), decoded);
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    Buffer mixedInput(size_t size) {
+        Buffer input;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (size_t i = 0; i < size; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            // mostly a few letters, with a tail of rarer bytes
+            input.pushBack(static_cast<uint8_t>(
+                    state % 4 ? 'a' + state % 6 : state % 97));
+        }
+        return input;
+    }
+
+    Packed encodeWithStreams(const Buffer &input, size_t streams,
+                             size_t syncInterval = 0,
+                             bool recordSize = false) {
+        EncoderOptions options;
+        options.streams = streams;
+        options.syncInterval = syncInterval;
+        options.recordSize = recordSize;
+        // keep the coded layout even where it does not shrink the input
+        options.allowStored = false;
+        Packed encoded;
+        Encoder::encode(input.data(), input.size(), encoded, options);
+        return encoded;
+    }
+
+    void testMultiStreamRoundTrip() {
+        const size_t sizes[] = {1, 7, 1000, 100003};
+        const size_t streamCounts[] = {2, 4, 8};
+        for (size_t size : sizes)
+            for (size_t streams : streamCounts) {
+                const Buffer input = mixedInput(size);
+                const Packed encoded = encodeWithStreams(input, streams);
+
+                Buffer decoded;
+                Decoder::decode(encoded.data(), encoded.size(), decoded);
+                assert(decoded.size() == input.size());
+                for (size_t i = 0; i < input.size(); ++i)
+                    assert(decoded[i] == input[i]);
+
+                // short reads leave the reader between sub-streams
+                DataReader reader =
+                        Decoder::openReader(encoded.data(), encoded.size());
+                Buffer chunked;
+                uint8_t span[13];
+                size_t produced;
+                while ((produced = reader.read(span, sizeof(span))) != 0)
+                    chunked.append(span, produced);
+                assert(reader.atEnd());
+                assert(chunked.size() == input.size());
+                for (size_t i = 0; i < input.size(); ++i)
+                    assert(chunked[i] == input[i]);
+            }
+    }
+
+    bool decodeThrows(const Packed &encoded) {
+        Buffer decoded;
+        try {
+            Decoder::decode(encoded.data(), encoded.size(), decoded);
+        } catch (const FanoException &) {
+            return true;
+        }
+        return false;
+    }
+
+    void testMultiStreamThrowsOnCorruptHeader() {
+        const Packed encoded = encodeWithStreams(mixedInput(1000), 4);
+        const size_t firstLength = format::EXTENDED_HEADER_SIZE;
+
+        Packed flags = encoded;
+        flags[1] = 1;
+        assert(decodeThrows(flags));
+
+        Packed streamCount = encoded;
+        streamCount[2] = 3;
+        assert(decodeThrows(streamCount));
+
+        // one bit short: the sub-streams no longer end together
+        Packed shorter = encoded;
+        shorter[firstLength] = static_cast<uint8_t>(shorter[firstLength] - 1);
+        assert(decodeThrows(shorter));
+
+        Packed longer = encoded;
+        longer[firstLength + format::STREAM_LENGTH_SIZE - 1] = 0xFF;
+        assert(decodeThrows(longer));
+
+        Packed truncated = encoded;
+        truncated.popBack();
+        assert(decodeThrows(truncated));
+    }
+
+    void testSyncIndexParallelRoundTrip() {
+        const size_t sizes[] = {1, 1000, 100003};
+        const size_t streamCounts[] = {1, 4};
+        const size_t threadCounts[] = {1, 3, 0};
+        for (size_t size : sizes)
+            for (size_t streams : streamCounts) {
+                const Buffer input = mixedInput(size);
+                const Packed encoded = encodeWithStreams(input, streams, 97);
+                assert(encoded[1] == format::FLAG_SYNC_INDEX);
+
+                for (size_t threads : threadCounts) {
+                    DecoderOptions options;
+                    options.threads = threads;
+                    Buffer decoded;
+                    Decoder::decode(encoded.data(), encoded.size(), decoded,
+                                    options);
+                    assert(decoded.size() == input.size());
+                    for (size_t i = 0; i < input.size(); ++i)
+                        assert(decoded[i] == input[i]);
+                }
+            }
+    }
+
+    void testSyncIndexOverheadIsSmall() {
+        const Buffer input = mixedInput(1 << 20);
+        Packed plain;
+        Encoder::encode(input.data(), input.size(), plain);
+        const Packed indexed = encodeWithStreams(
+                input, 1, EncoderOptions::DEFAULT_SYNC_INTERVAL);
+        assert(indexed.size() > plain.size());
+        assert((indexed.size() - plain.size()) * 1000 < plain.size());
+    }
+
+    void testSyncIndexThrowsOnBadOffsets() {
+        const Packed encoded = encodeWithStreams(mixedInput(1000), 1, 100);
+        // the first offset follows the stream length and the sync header
+        const size_t firstOffset = format::EXTENDED_HEADER_SIZE +
+                format::STREAM_LENGTH_SIZE + format::SYNC_HEADER_SIZE;
+        DecoderOptions options;
+        options.threads = 2;
+
+        Packed shifted = encoded;
+        shifted[firstOffset] = static_cast<uint8_t>(shifted[firstOffset] + 1);
+        Buffer decoded;
+        bool caught = false;
+        try {
+            Decoder::decode(shifted.data(), shifted.size(), decoded, options);
+        } catch (const FanoException &) {
+            caught = true;
+        }
+        assert(caught);
+
+        // an interval this large claims gigabytes of output before the
+        // last point; the header must be rejected before anything is sized
+        const size_t intervalField = format::EXTENDED_HEADER_SIZE +
+                format::STREAM_LENGTH_SIZE;
+        Packed huge = encoded;
+        for (size_t i = 0; i < format::SYNC_FIELD_SIZE; ++i)
+            huge[intervalField + i] = 0xFF;
+        caught = false;
+        try {
+            Decoder::decode(huge.data(), huge.size(), decoded, options);
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+
+        Packed pastEnd = encoded;
+        pastEnd[firstOffset + format::SYNC_OFFSET_SIZE - 1] = 0x7F;
+        caught = false;
+        try {
+            Decoder::decode(pastEnd.data(), pastEnd.size(), decoded, options);
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    // Four equally likely bytes get four 2-bit codes, so a thread started
+    // at an odd bit offset never meets the true path.
+    Buffer evenCodeInput(size_t size) {
+        Buffer input;
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (size_t i = 0; i < size; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            input.pushBack(static_cast<uint8_t>('w' + (state >> 32) % 4));
+        }
+        return input;
+    }
+
+    void testSpeculativeDecodeOfLegacyFiles() {
+        const Buffer inputs[] = {
+                mixedInput(300001), evenCodeInput(100003), mixedInput(5000)
+        };
+        const size_t threadCounts[] = {2, 3, 8};
+        for (const Buffer &input : inputs) {
+            Packed encoded;
+            Encoder::encode(input.data(), input.size(), encoded);
+
+            for (size_t threads : threadCounts) {
+                DecoderOptions options;
+                options.threads = threads;
+                options.speculative = true;
+                Buffer decoded;
+                Decoder::decode(encoded.data(), encoded.size(), decoded,
+                                options);
+                assert(decoded.size() == input.size());
+                for (size_t i = 0; i < input.size(); ++i)
+                    assert(decoded[i] == input[i]);
+            }
+        }
+    }
+
+    void testSpeculativeDecodeReportsBadInput() {
+        const Buffer input = mixedInput(300001);
+        Packed encoded;
+        Encoder::encode(input.data(), input.size(), encoded);
+        // claim one more trailing bit than the last byte has
+        encoded[0] = static_cast<uint8_t>((encoded[0] + 1) % 8);
+        if (encoded[0] == 0)
+            encoded.popBack();
+
+        DecoderOptions options;
+        options.threads = 4;
+        options.speculative = true;
+        Buffer decoded;
+        bool caught = false;
+        try {
+            Decoder::decode(encoded.data(), encoded.size(), decoded, options);
+        } catch (const FanoException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    // Fails every allocation made off the thread that created it.
+    class CallerOnlyResource : public MemoryResource {
+    public:
+        void *allocate(size_t bytes, size_t alignment) override {
+            if (std::this_thread::get_id() != owner_)
+                throw std::bad_alloc();
+            return defaultResource()->allocate(bytes, alignment);
+        }
+
+        void deallocate(void *pointer, size_t bytes,
+                        size_t alignment) override {
+            defaultResource()->deallocate(pointer, bytes, alignment);
+        }
+
+    private:
+        std::thread::id owner_ = std::this_thread::get_id();
+    };
+
+    void testSpeculativeWorkerErrorsFallBack() {
+        const Buffer input = mixedInput(300001);
+        Packed encoded;
+        Encoder::encode(input.data(), input.size(), encoded);
+
+        CallerOnlyResource resource;
+        DecoderOptions options;
+        options.threads = 4;
+        options.speculative = true;
+        Buffer decoded;
+        {
+            MemoryResourceScope scope(&resource);
+            Buffer local;
+            Decoder::decode(encoded.data(), encoded.size(), local, options);
+            decoded = local;
+        }
+        assert(decoded.size() == input.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            assert(decoded[i] == input[i]);
+    }
+
+    void testRecordedSizeRoundTrip() {
+        const size_t sizes[] = {1, 1000, 100003};
+        const size_t streamCounts[] = {1, 4};
+        const size_t syncIntervals[] = {0, 97};
+        for (size_t size : sizes)
+            for (size_t streams : streamCounts)
+                for (size_t syncInterval : syncIntervals) {
+                    const Buffer input = mixedInput(size);
+                    const Packed encoded = encodeWithStreams(
+                            input, streams, syncInterval, true);
+
+                    size_t recorded = 0;
+                    assert(Decoder::originalSize(encoded.data(),
+                                                 encoded.size(), recorded));
+                    assert(recorded == size);
+
+                    DecoderOptions options;
+                    options.threads = 3;
+                    Buffer decoded;
+                    Decoder::decode(encoded.data(), encoded.size(), decoded,
+                                    options);
+                    assert(decoded.size() == size);
+
+                    Buffer direct(size, 0);
+                    Decoder::decode(encoded.data(), encoded.size(),
+                                    direct.data(), direct.size(), options);
+                    for (size_t i = 0; i < size; ++i) {
+                        assert(decoded[i] == input[i]);
+                        assert(direct[i] == input[i]);
+                    }
+                }
+    }
+
+    void testRecordedSizeMismatchThrows() {
+        const Buffer input = mixedInput(1000);
+        const Packed encoded = encodeWithStreams(input, 2, 0, true);
+        const size_t sizeField = format::EXTENDED_HEADER_SIZE +
+                2 * format::STREAM_LENGTH_SIZE;
+
+        const uint8_t changes[] = {0xE7, 0xE9, 0xFF};
+        for (uint8_t change : changes) {
+            Packed wrong = encoded;
+            wrong[sizeField] = change; // 1000 is 0x03E8
+            assert(decodeThrows(wrong));
+        }
+
+        Buffer small(size_t{999}, 0);
+        bool caught = false;
+        try {
+            Decoder::decode(encoded.data(), encoded.size(), small.data(),
+                            small.size());
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+
+        Packed legacy;
+        Encoder::encode(input.data(), input.size(), legacy);
+        size_t recorded;
+        assert(!Decoder::originalSize(legacy.data(), legacy.size(),
+                                      recorded));
+    }
+
+    void testRecordedSizeDecodesIntoFile() {
+        const String encodedFile("decoder_test_sized.tmp");
+        const String outputFile("decoder_test_sized_output.tmp");
+        const Buffer input = mixedInput(20000);
+        file_io::writeToFile(encodedFile,
+                             encodeWithStreams(input, 4, 0, true));
+
+        const bool modes[] = {false, true};
+        for (bool map : modes) {
+            DecoderOptions options;
+            options.mapOutput = map;
+            Decoder::decode(encodedFile, outputFile, options);
+
+            const Buffer decoded = file_io::readFileToBuffer(outputFile);
+            assert(decoded.size() == input.size());
+            for (size_t i = 0; i < input.size(); ++i)
+                assert(decoded[i] == input[i]);
+        }
+
+        std::remove(encodedFile.c_str());
+        std::remove(outputFile.c_str());
+    }
+
+    void testOriginalSizeReadsOnlyTheHeader() {
+        const Buffer input = mixedInput(1000);
+        Packed truncated = encodeWithStreams(input, 2, 0, true);
+        truncated.popBack();
+
+        // the data is not looked at until decode
+        size_t recorded = 0;
+        assert(Decoder::originalSize(truncated.data(), truncated.size(),
+                                     recorded));
+        assert(recorded == 1000);
+        assert(decodeThrows(truncated));
+
+        const size_t sizeField = format::EXTENDED_HEADER_SIZE +
+                2 * format::STREAM_LENGTH_SIZE;
+        Packed header(truncated.data(), truncated.data() + sizeField);
+        bool caught = false;
+        try {
+            Decoder::originalSize(header.data(), header.size(), recorded);
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    void testFullAlphabetRoundTrip() {
+        Buffer input;
+        for (size_t i = 0; i < 50000; i++)
+            input.pushBack(static_cast<uint8_t>(i * i + i / 256));
+        const size_t streamCounts[] = {1, 4};
+        for (size_t streams : streamCounts) {
+            Packed legacy;
+            EncoderOptions options;
+            options.streams = streams;
+            options.allowStored = false;
+            Encoder::encode(input.data(), input.size(), legacy, options);
+            if (streams == 1)
+                assert(legacy[1] == 0); // 256 entries
+
+            Buffer decoded;
+            Decoder::decode(legacy.data(), legacy.size(), decoded);
+            assert(decoded.size() == input.size());
+            for (size_t i = 0; i < input.size(); ++i)
+                assert(decoded[i] == input[i]);
+        }
+    }
+
+    void testStoredBlockRoundTrip() {
+        const String encodedFile("decoder_test_stored.tmp");
+        const String outputFile("decoder_test_stored_output.tmp");
+        Buffer input;
+        for (size_t i = 0; i < 3000; i++)
+            input.pushBack(static_cast<uint8_t>(i * 7 + i / 256));
+
+        Packed encoded;
+        Encoder::encode(input.data(), input.size(), encoded);
+        assert(encoded[0] == format::STORED_MARKER);
+
+        size_t recorded = 0;
+        assert(Decoder::originalSize(encoded.data(), encoded.size(),
+                                     recorded));
+        assert(recorded == input.size());
+
+        Buffer decoded;
+        Decoder::decode(encoded.data(), encoded.size(), decoded);
+        Buffer direct(input.size(), 0);
+        Decoder::decode(encoded.data(), encoded.size(), direct.data(),
+                        direct.size());
+        DataReader reader = Decoder::openReader(encoded.data(),
+                                                encoded.size());
+        Buffer chunked;
+        uint8_t span[13];
+        size_t produced;
+        while ((produced = reader.read(span, sizeof(span))) != 0)
+            chunked.append(span, produced);
+        assert(reader.atEnd());
+
+        assert(decoded.size() == input.size());
+        assert(chunked.size() == input.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            assert(decoded[i] == input[i]);
+            assert(direct[i] == input[i]);
+            assert(chunked[i] == input[i]);
+        }
+
+        Buffer small(input.size() - 1, 0);
+        bool caught = false;
+        try {
+            Decoder::decode(encoded.data(), encoded.size(), small.data(),
+                            small.size());
+        } catch (const DecoderException &) {
+            caught = true;
+        }
+        assert(caught);
+
+        file_io::writeToFile(encodedFile, encoded);
+        const bool modes[] = {false, true};
+        for (bool map : modes) {
+            DecoderOptions options;
+            options.mapOutput = map;
+            Decoder::decode(encodedFile, outputFile, options);
+
+            const Buffer fromFile = file_io::readFileToBuffer(outputFile);
+            assert(fromFile.size() == input.size());
+            for (size_t i = 0; i < input.size(); ++i)
+                assert(fromFile[i] == input[i]);
+        }
+
+        std::remove(encodedFile.c_str());
+        std::remove(outputFile.c_str());
+    }
+
     void runDecoderTest() {
         std::cout << "[DecoderTest] Running...\n";
         testDecoderWorksCorrectly();
+        testDecodeInMemoryRoundTrip();
+        testDecodeInMemoryThrowsOnTruncatedInput();
+        testMultiStreamRoundTrip();
+        testMultiStreamThrowsOnCorruptHeader();
+        testSyncIndexParallelRoundTrip();
+        testSyncIndexOverheadIsSmall();
+        testSyncIndexThrowsOnBadOffsets();
+        testSpeculativeDecodeOfLegacyFiles();
+        testSpeculativeDecodeReportsBadInput();
+        testSpeculativeWorkerErrorsFallBack();
+        testRecordedSizeRoundTrip();
+        testRecordedSizeMismatchThrows();
+        testRecordedSizeDecodesIntoFile();
+        testOriginalSizeReadsOnlyTheHeader();
+        testFullAlphabetRoundTrip();
+        testStoredBlockRoundTrip();
         std::cout << "[DecoderTest] All tests passed\n";
     }
 }
@@ -0,0 +1,40 @@
+#include "../include/EncoderContext.h"
+#include <cassert>
+#include <iostream>
+
+namespace EncoderContextTests {
+
+    void testBlocksAreEmittedWhenComplete() {
+        EncoderContext ctx(4);
+        Packed output;
+        const uint8_t first[] = {'a', 'b', 'a'};
+        ctx.update(first, sizeof(first), output);
+        assert(output.empty());
+
+        const uint8_t second[] = {'c', 'd'};
+        ctx.update(second, sizeof(second), output);
+        assert(!output.empty());
+
+        const size_t frameSize = output[0] | output[1] << 8 |
+                                 output[2] << 16 | output[3] << 24;
+        assert(output.size() == EncoderContext::FRAME_HEADER_SIZE + frameSize);
+
+        ctx.finish(output);
+        assert(output.size() > EncoderContext::FRAME_HEADER_SIZE + frameSize);
+    }
+
+    void testFinishWithoutInputEmitsNothing() {
+        EncoderContext ctx;
+        Packed output;
+        ctx.finish(output);
+        assert(output.empty());
+    }
+
+    void runEncoderContextTest() {
+        std::cout << "[EncoderContextTest] Running...\n";
+        testBlocksAreEmittedWhenComplete();
+        testFinishWithoutInputEmitsNothing();
+        std::cout << "[EncoderContextTest] All tests passed\n";
+    }
+
+}
@@ -27,9 +27,122 @@ namespace EncoderTests {
         std::remove(outputFile.c_str());
     }
 
+    void testEncodeInMemory() {
+        const uint8_t input[] = {'H', 'e', 'l', 'l', 'o'};
+        Packed output;
+        // too short to shrink, so it would be stored otherwise
+        EncoderOptions options;
+        options.allowStored = false;
+
+        Encoder::encode(input, sizeof(input), output, options);
+
+        assert(output.size() > 3);
+        assert(output[1] == 4); // number of distinct symbols
+    }
+
+    void testEncodeInMemoryThrowsOnEmpty() {
+        Packed output;
+        bool caught = false;
+        try {
+            Encoder::encode(nullptr, 0, output);
+        } catch (const EncoderException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    void testEncodeRejectsUnsupportedStreamCount() {
+        const uint8_t input[] = {'H', 'e', 'l', 'l', 'o'};
+        Packed output;
+        const size_t unsupported[] = {0, 3, 16};
+        for (size_t streams : unsupported) {
+            EncoderOptions options;
+            options.streams = streams;
+            bool caught = false;
+            try {
+                Encoder::encode(input, sizeof(input), output, options);
+            } catch (const EncoderException &) {
+                caught = true;
+            }
+            assert(caught);
+        }
+    }
+
+    void testSingleStreamKeepsLegacyFormat() {
+        const uint8_t input[] = {'H', 'e', 'l', 'l', 'o'};
+        EncoderOptions options;
+        options.allowStored = false;
+        Packed legacy;
+        Encoder::encode(input, sizeof(input), legacy, options);
+
+        options.streams = 1;
+        Packed single;
+        Encoder::encode(input, sizeof(input), single, options);
+
+        assert(single.size() == legacy.size());
+        for (size_t i = 0; i < legacy.size(); ++i)
+            assert(single[i] == legacy[i]);
+
+        options.streams = 4;
+        Packed interleaved;
+        Encoder::encode(input, sizeof(input), interleaved, options);
+        assert(interleaved[0] == format::EXTENDED_MARKER);
+        assert(interleaved[2] == 4);
+    }
+
+    void testIncompressibleInputIsStored() {
+        Packed input;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (size_t i = 0; i < 4096; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            input.pushBack(static_cast<uint8_t>(state >> 24));
+        }
+
+        const size_t streamCounts[] = {1, 4};
+        for (size_t streams : streamCounts) {
+            EncoderOptions options;
+            options.streams = streams;
+            options.recordSize = true;
+            Packed output;
+            Encoder::encode(input.data(), input.size(), output, options);
+
+            assert(output.size() == input.size() + format::STORED_HEADER_SIZE);
+            assert(output[0] == format::STORED_MARKER);
+            for (size_t i = 0; i < input.size(); ++i)
+                assert(output[i + format::STORED_HEADER_SIZE] == input[i]);
+        }
+    }
+
+    void testCompressibleInputIsCoded() {
+        const char text[] = "abracadabra, abracadabra, abracadabra";
+        const auto *input = reinterpret_cast<const uint8_t *>(text);
+        const size_t size = sizeof(text) - 1;
+
+        Packed coded;
+        Encoder::encode(input, size, coded);
+        assert(coded.size() < size);
+        assert(coded[0] != format::STORED_MARKER);
+
+        EncoderOptions options;
+        options.allowStored = false;
+        Packed forced;
+        Encoder::encode(input, size, forced, options);
+        assert(forced.size() == coded.size());
+        for (size_t i = 0; i < coded.size(); ++i)
+            assert(forced[i] == coded[i]);
+    }
+
     void runEncoderTest() {
         std::cout << "[EncoderTest] Running...\n";
         testEncoderWorksAndProducesOutput();
+        testEncodeInMemory();
+        testEncodeInMemoryThrowsOnEmpty();
+        testEncodeRejectsUnsupportedStreamCount();
+        testSingleStreamKeepsLegacyFormat();
+        testIncompressibleInputIsStored();
+        testCompressibleInputIsCoded();
         std::cout << "[EncoderTest] All tests passed\n";
     }
 
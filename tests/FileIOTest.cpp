@@ -79,6 +79,68 @@ namespace FileIOTests {
         std::remove(filename.c_str());
     }
 
+    void testOutputFileWritesItsSize() {
+        const String path("output_file_test.tmp");
+        const bool modes[] = {false, true};
+        for (bool map : modes) {
+            {
+                file_io::OutputFile output(path, 5000, map);
+                assert(output.size() == 5000);
+                for (size_t i = 0; i < output.size(); ++i)
+                    output.data()[i] = static_cast<uint8_t>(i * 7);
+                output.commit();
+            }
+            const Buffer written = file_io::readFileToBuffer(path);
+            assert(written.size() == 5000);
+            for (size_t i = 0; i < written.size(); ++i)
+                assert(written[i] == static_cast<uint8_t>(i * 7));
+        }
+        std::remove(path.c_str());
+    }
+
+    void testOutputFileWithoutCommitIsRemoved() {
+        const String path("output_file_abandoned.tmp");
+        {
+            file_io::OutputFile output(path, 100, true);
+            output.data()[0] = 1;
+        }
+        bool caught = false;
+        try {
+            file_io::readFileToBuffer(path);
+        } catch (const FileException &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    void testOutputFileWithoutCommitKeepsExistingFile() {
+        const String path("output_file_existing.tmp");
+        Packed original;
+        original.pushBack(0x4B);
+        original.pushBack(0x50);
+        file_io::writeToFile(path, original);
+
+        const bool modes[] = {false, true};
+        for (bool map : modes) {
+            {
+                file_io::OutputFile output(path, 100, map);
+                output.data()[0] = 1;
+            }
+            const Buffer kept = file_io::readFileToBuffer(path);
+            assert(kept == original);
+        }
+
+        // nor is the temporary left next to it
+        bool caught = false;
+        try {
+            file_io::readFileToBuffer(path + ".tmp");
+        } catch (const FileException &) {
+            caught = true;
+        }
+        assert(caught);
+        std::remove(path.c_str());
+    }
+
     void runFileIOTest() {
         std::cout << "[FileIOTest] Running...\n";
         testCheckFilesValid();
@@ -87,6 +149,9 @@ namespace FileIOTests {
         testWriteAndReadFile();
         testReadNonexistentThrows();
         testGetFileSize();
+        testOutputFileWritesItsSize();
+        testOutputFileWithoutCommitIsRemoved();
+        testOutputFileWithoutCommitKeepsExistingFile();
         std::cout << "[FileIOTest] All tests passed\n";
     }
 
@@ -0,0 +1,99 @@
+#include "../include/Profiler.h"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace ProfilerTests {
+
+    void runNestedPhases() {
+        ProfileScope outer("outer", 100);
+        for (int i = 0; i < 3; ++i) {
+            ProfileScope inner("inner");
+            inner.addBytes(10);
+        }
+    }
+
+    std::string jsonReport() {
+        std::ostringstream os;
+        Profiler::report(os, Profiler::Format::JSON);
+        return os.str();
+    }
+
+    void testDisabledProfilerRecordsNothing() {
+        Profiler::reset();
+        runNestedPhases();
+        assert(jsonReport().find("outer") == std::string::npos);
+    }
+
+    void testPhasesAggregateAcrossThreads() {
+        Profiler::reset();
+        Profiler::enable();
+        runNestedPhases();
+        std::thread worker(runNestedPhases);
+        worker.join();
+        Profiler::disable();
+
+        const std::string json = jsonReport();
+        assert(json.find("\"path\": \"outer\", \"calls\": 2,") != std::string::npos);
+        assert(json.find("\"path\": \"outer/inner\", \"calls\": 6,") != std::string::npos);
+        assert(json.find("\"bytes\": 60") != std::string::npos);
+
+        std::ostringstream table;
+        Profiler::report(table, Profiler::Format::TABLE);
+        assert(table.str().find("  inner") != std::string::npos);
+        Profiler::reset();
+    }
+
+    void testCountersReportOrFallBack() {
+        Profiler::reset();
+        Profiler::enable();
+        Profiler::enableCounters();
+        runNestedPhases();
+        Profiler::disable();
+
+        const std::string json = jsonReport();
+        assert(json.find("\"path\": \"outer/inner\"") != std::string::npos);
+        if (PerfCounters::availableEvents() == 0)
+            assert(json.find("\"counters\": \"unavailable\"") != std::string::npos);
+        else
+            assert(json.find("PerByte") != std::string::npos);
+        Profiler::reset();
+    }
+
+    void testCounterDifferenceScalesMultiplexedGroups() {
+        PerfCounters::Sample start = {};
+        PerfCounters::Sample end = {};
+        start.values[PerfCounters::CYCLES] = 1000;
+        end.values[PerfCounters::CYCLES] = 1500;
+        start.timeEnabled = start.timeRunning = 100;
+        end.timeEnabled = 300;
+        uint64_t counts[PerfCounters::EVENT_COUNT];
+
+        // on the PMU the whole time: the raw difference
+        end.timeRunning = 300;
+        assert(PerfCounters::difference(start, end, counts));
+        assert(counts[PerfCounters::CYCLES] == 500);
+
+        // scheduled for half the interval
+        end.timeRunning = 200;
+        assert(PerfCounters::difference(start, end, counts));
+        assert(counts[PerfCounters::CYCLES] == 1000);
+        assert(counts[PerfCounters::INSTRUCTIONS] == 0);
+
+        // never scheduled: nothing is known
+        end.timeRunning = 100;
+        assert(!PerfCounters::difference(start, end, counts));
+    }
+
+    void runProfilerTest() {
+        std::cout << "[ProfilerTest] Running...\n";
+        testDisabledProfilerRecordsNothing();
+        testPhasesAggregateAcrossThreads();
+        testCountersReportOrFallBack();
+        testCounterDifferenceScalesMultiplexedGroups();
+        std::cout << "[ProfilerTest] All tests passed\n";
+    }
+
+}
@@ -21,7 +21,7 @@ namespace TableTests {
         restored.decode(cleaned, bitsPerCode);
         uint8_t byte = 0;
         for (const Pair<const uint8_t &, const ByteEntry &> pair : table.getRawTable()) {
-            const Encoded &code = pair.second.code;
+            const Code &code = pair.second.code;
             bool success = restored.getByteByCode(code, byte);
             assert(success);
             assert(byte == pair.first);
@@ -39,10 +39,80 @@ namespace TableTests {
         assert(caught);
     }
 
+    void testCodeKeysDistinguishLength() {
+        Code zero;
+        zero.pushBack(false);
+        Code zeroZero = zero;
+        zeroZero.pushBack(false);
+        assert(zero.bits == zeroZero.bits);
+        assert(zero.key() != zeroZero.key());
+    }
+
+    void testCodesRoundTripThroughReverseLookup() {
+        Buffer buffer;
+        for (int i = 0; i < 200; ++i)
+            buffer.pushBack(static_cast<uint8_t>(i % 7 == 0 ? 'z' : 'a' + i % 5));
+
+        Table table(buffer);
+        const Encoded encoded = table.encode();
+        const uint8_t width = static_cast<uint8_t>(encoded.getBits(8, 8));
+        Table restored;
+        restored.decode(Encoded(encoded.begin() + 16, encoded.end()), width);
+
+        uint8_t byte = 0;
+        for (const Pair<const uint8_t &, const ByteEntry &> pair : table.getRawTable()) {
+            const Code &code = table.getCodeForByte(pair.first);
+            assert(code.length > 0 && code.bits >> code.length == 0);
+            assert(restored.getCodeForByte(pair.first) == code);
+            assert(restored.getByteByCode(code, byte) && byte == pair.first);
+        }
+    }
+
+    void testCountsAbove32Bits() {
+        size_t counts[Table::SYMBOL_COUNT] = {};
+        counts['a'] = size_t{5} << 32;
+        counts['b'] = size_t{3} << 32;
+        counts['c'] = size_t{2} << 32;
+        const Table table = Table::fromHistogram(counts);
+
+        // the same codes as for the counts scaled down
+        size_t small[Table::SYMBOL_COUNT] = {};
+        small['a'] = 5;
+        small['b'] = 3;
+        small['c'] = 2;
+        const Table reference = Table::fromHistogram(small);
+
+        assert(table.getRawTable()['a'].occurrences == counts['a']);
+        assert(table.getCodeForByte('a') == reference.getCodeForByte('a'));
+        assert(table.getCodeForByte('b') == reference.getCodeForByte('b'));
+        assert(table.getCodeForByte('c') == reference.getCodeForByte('c'));
+
+        // the frequencies are 0.5, 0.3 and 0.2 whatever the total
+        const double entropy = table.calculateEntropy();
+        assert(entropy > 1.48 && entropy < 1.49);
+    }
+
+    void testFullAlphabetEncodesZeroEntries() {
+        size_t counts[Table::SYMBOL_COUNT];
+        for (size_t symbol = 0; symbol < Table::SYMBOL_COUNT; symbol++)
+            counts[symbol] = symbol + 1;
+        Table table = Table::fromHistogram(counts);
+        const Encoded encoded = table.encode();
+
+        assert(encoded.getBits(0, 8) == 0);
+        const uint8_t bitsPerCode = static_cast<uint8_t>(encoded.getBits(8, 8));
+        assert(encoded.size() ==
+               size_t{16} + 256 * (8 + size_t{bitsPerCode}));
+    }
+
     void runTableTest() {
         std::cout << "[TableTest] Running...\n";
         testTableBuildAndEncodeDecode();
         testTableThrowsOnEmptyBuffer();
+        testCodeKeysDistinguishLength();
+        testCodesRoundTripThroughReverseLookup();
+        testCountsAbove32Bits();
+        testFullAlphabetEncodesZeroEntries();
         std::cout << "[TableTest] All tests passed\n";
     }
 
@@ -1,5 +1,7 @@
 #include "../include/UnorderedMap.h"
 #include <cassert>
+#include <cstdint>
+#include <stdexcept>
 #include <iostream>
 
 namespace UnorderedMapTests {
@@ -89,6 +91,100 @@ namespace UnorderedMapTests {
         }
     }
 
+    void testTryEmplace() {
+        UnorderedMap<int, std::string> map;
+        assert(map.tryEmplace(1, 3, 'x'));
+        assert(map[1] == "xxx");
+        assert(!map.tryEmplace(1, "ignored"));
+        assert(map[1] == "xxx");
+        assert(map.size() == 1);
+    }
+
+    void testMoveInsertSurvivesRehash() {
+        UnorderedMap<int, std::string> map;
+        for (int i = 0; i < 100; ++i) {
+            std::string value(50, static_cast<char>('a' + i % 26));
+            map.insert(i, std::move(value));
+        }
+        for (int i = 0; i < 100; ++i)
+            assert(map[i] == std::string(50, static_cast<char>('a' + i % 26)));
+    }
+
+    void testEraseChurn() {
+        UnorderedMap<int, int> map;
+        for (int round = 0; round < 50; ++round) {
+            for (int i = 0; i < 40; ++i)
+                map.insert(round * 40 + i, i);
+            for (int i = 0; i < 40; ++i)
+                assert(map.erase(round * 40 + i));
+        }
+        assert(map.empty());
+        map.insert(7, 7);
+        assert(map.contains(7) && !map.contains(47));
+    }
+
+    void testReserveAndClearReuse() {
+        UnorderedMap<int, std::string> map;
+        map.reserve(256);
+        for (int i = 0; i < 256; ++i)
+            map.insert(i, std::to_string(i));
+        map.clear();
+        assert(map.empty() && !(map.begin() != map.end()));
+        for (int i = 0; i < 10; ++i)
+            map.insert(i, std::to_string(i));
+        assert(map.size() == 10 && map[9] == "9");
+    }
+
+    void testCopyAndMove() {
+        UnorderedMap<int, int> map;
+        for (int i = 0; i < 30; ++i)
+            map.insert(i, i * i);
+        UnorderedMap<int, int> copy(map);
+        UnorderedMap<int, int> moved(std::move(map));
+        assert(map.empty() && !map.contains(3));
+        assert(copy.size() == 30 && moved.size() == 30);
+        for (int i = 0; i < 30; ++i)
+            assert(copy[i] == i * i && moved[i] == i * i);
+    }
+
+    void testByteKeysIterateInOrder() {
+        UnorderedMap<uint8_t, int> map;
+        const uint8_t keys[] = {200, 3, 255, 0, 64, 63};
+        for (const uint8_t key : keys)
+            map[key] = key * 2;
+        assert(map.size() == 6);
+
+        int previous = -1;
+        for (const auto pair : map) {
+            assert(pair.first > previous);
+            assert(pair.second == pair.first * 2);
+            previous = pair.first;
+        }
+        assert(previous == 255);
+    }
+
+    void testByteKeysEraseAndCopy() {
+        ByteMap<std::string> map;
+        map.insert(10, "ten");
+        assert(map.tryEmplace(20, "twenty"));
+        assert(!map.tryEmplace(20, "again"));
+        assert(map.erase(10) && !map.erase(10));
+        assert(!map.contains(10) && map.contains(20));
+
+        const ByteMap<std::string> copy(map);
+        ByteMap<std::string> moved(std::move(map));
+        assert(map.empty());
+        assert(copy[20] == "twenty" && moved[20] == "twenty");
+
+        bool threw = false;
+        try {
+            copy[10];
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
     void runUnorderedMapTest() {
         std::cout << "[UnorderedMapTest] Running...\n";
         testInsertAndAccess();
@@ -101,6 +197,13 @@ namespace UnorderedMapTests {
         testRehashing();
         testIteratorAndRange();
         testConstIterator();
+        testTryEmplace();
+        testMoveInsertSurvivesRehash();
+        testEraseChurn();
+        testReserveAndClearReuse();
+        testCopyAndMove();
+        testByteKeysIterateInOrder();
+        testByteKeysEraseAndCopy();
         std::cout << "[UnorderedMapTest] All tests passed\n";
     }
 }
@@ -1,6 +1,10 @@
 #include "../include/Vector.h"
 #include <iostream>
 #include <cassert>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
 
 namespace VectorTests {
     void testDefaultConstructor() {
@@ -100,6 +104,19 @@ namespace VectorTests {
         assert(caught);
     }
 
+    void testAtThrowsOutOfRange() {
+        Vector<int> v;
+        v.pushBack(1);
+        assert(v.at(0) == 1);
+        bool caught = false;
+        try {
+            v.at(1);
+        } catch (const std::out_of_range &) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
     void testClear() {
         Vector<int> v;
         v.pushBack(1);
@@ -110,6 +127,149 @@ namespace VectorTests {
         assert(v.empty());
     }
 
+    void testDefaultConstructorDoesNotAllocate() {
+        Vector<int> v;
+        assert(v.capacity() == 0);
+        assert(v.data() == nullptr);
+    }
+
+    void testInlineStorage() {
+        Vector<int, 4> v;
+        for (int i = 0; i < 4; ++i)
+            v.pushBack(i);
+        assert(v.isInline());
+        assert(v.capacity() == 4);
+
+        Vector<int, 4> copy(v);
+        assert(copy.isInline());
+        assert(copy == v);
+
+        v.pushBack(4);
+        assert(!v.isInline());
+        assert(v.size() == 5);
+        for (int i = 0; i < 5; ++i)
+            assert(v[i] == i);
+    }
+
+    void testInlineMove() {
+        Vector<int, 4> inlineVector;
+        inlineVector.pushBack(7);
+        Vector<int, 4> movedInline(std::move(inlineVector));
+        assert(movedInline.isInline());
+        assert(movedInline.size() == 1);
+        assert(movedInline[0] == 7);
+        assert(inlineVector.empty());
+
+        Vector<int, 2> heapVector;
+        for (int i = 0; i < 10; ++i)
+            heapVector.pushBack(i);
+        const int *storage = heapVector.data();
+        Vector<int, 2> movedHeap(std::move(heapVector));
+        assert(movedHeap.data() == storage);
+        assert(movedHeap.size() == 10);
+        assert(heapVector.isInline());
+        assert(heapVector.empty());
+    }
+
+    void testReserveKeepsElements() {
+        Vector<int> v;
+        v.pushBack(1);
+        v.pushBack(2);
+        v.reserve(100);
+        assert(v.capacity() >= 100);
+        assert(v.size() == 2);
+        assert(v[0] == 1 && v[1] == 2);
+    }
+
+    void testResizeUninitialized() {
+        Vector<uint8_t> v;
+        v.resizeUninitialized(16);
+        assert(v.size() == 16);
+        v.resizeUninitialized(3);
+        assert(v.size() == 3);
+
+        Vector<std::string> strings;
+        strings.resizeUninitialized(2);
+        assert(strings[0].empty() && strings[1].empty());
+    }
+
+    void testAppendAndInsert() {
+        const int values[] = {1, 2, 3};
+        Vector<int> v;
+        v.append(values, 3);
+        const int middle[] = {8, 9};
+        v.insert(1, middle, 2);
+        const int expected[] = {1, 8, 9, 2, 3};
+        assert(v.size() == 5);
+        for (size_t i = 0; i < v.size(); ++i)
+            assert(v[i] == expected[i]);
+
+        v.append(v.data(), v.size());
+        assert(v.size() == 10);
+        assert(v[5] == 1 && v[9] == 3);
+    }
+
+    void testInsertNonTrivial() {
+        Vector<std::string> v;
+        v.pushBack("a");
+        v.pushBack("d");
+        const std::string middle[] = {"b", "c"};
+        v.insert(1, middle, 2);
+        assert(v.size() == 4);
+        assert(v[0] == "a" && v[1] == "b" && v[2] == "c" && v[3] == "d");
+
+        Vector<std::string> copy(v);
+        v.clear();
+        assert(copy.size() == 4 && copy[3] == "d");
+    }
+
+    void testEmplaceBackAndMoveOnlyGrowth() {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < 20; ++i)
+            v.emplaceBack(new int(i));
+        assert(v.size() == 20);
+        for (int i = 0; i < 20; ++i)
+            assert(*v[i] == i);
+
+        std::unique_ptr<int> last(new int(99));
+        v.pushBack(std::move(last));
+        assert(!last);
+        assert(*v[20] == 99);
+    }
+
+    class FailingResource : public MemoryResource {
+    public:
+        void *allocate(size_t, size_t) override {
+            throw std::bad_alloc();
+        }
+
+        void deallocate(void *, size_t, size_t) override {
+        }
+    };
+
+    void testMoveAssignAcrossResourcesCanThrow() {
+        static_assert(std::is_nothrow_move_constructible<Vector<int>>::value,
+                      "move construction takes the storage over");
+        static_assert(!std::is_nothrow_move_assignable<Vector<int>>::value,
+                      "move assignment may allocate");
+
+        Vector<int> source;
+        for (int i = 0; i < 100; ++i)
+            source.pushBack(i);
+
+        FailingResource failing;
+        MemoryResourceScope scope(&failing);
+        Vector<int> target;
+        bool caught = false;
+        try {
+            target = std::move(source);
+        } catch (const std::bad_alloc &) {
+            caught = true;
+        }
+        assert(caught);
+        assert(target.empty());
+    }
+
     void runVectorTest() {
         std::cout << "[VectorTest] Running...\n";
         testDefaultConstructor();
@@ -121,7 +281,17 @@ namespace VectorTests {
         testMoveAssignment();
         testOperatorPlusEquals();
         testOutOfRangeException();
+        testAtThrowsOutOfRange();
         testClear();
+        testDefaultConstructorDoesNotAllocate();
+        testInlineStorage();
+        testInlineMove();
+        testReserveKeepsElements();
+        testResizeUninitialized();
+        testAppendAndInsert();
+        testInsertNonTrivial();
+        testEmplaceBackAndMoveOnlyGrowth();
+        testMoveAssignAcrossResourcesCanThrow();
         std::cout << "[VectorTest] All tests passed\n";
     }
 }
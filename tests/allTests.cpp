@@ -4,6 +4,10 @@ namespace VectorTests {
     void runVectorTest();
 }
 
+namespace BitVectorTests {
+    void runBitVectorTest();
+}
+
 namespace UnorderedMapTests {
     void runUnorderedMapTest();
 }
@@ -16,6 +20,10 @@ namespace BitUtilsTests {
     void runBitUtilsTest();
 }
 
+namespace BitKernelsTests {
+    void runBitKernelsTest();
+}
+
 namespace FileIOTests {
     void runFileIOTest();
 }
@@ -40,19 +48,46 @@ namespace DecoderTests {
     void runDecoderTest();
 }
 
+namespace DataReaderTests {
+    void runDataReaderTest();
+}
+
+namespace EncoderContextTests {
+    void runEncoderContextTest();
+}
+
+namespace DecoderContextTests {
+    void runDecoderContextTest();
+}
+
+namespace ArenaTests {
+    void runArenaTest();
+}
+
+namespace ProfilerTests {
+    void runProfilerTest();
+}
+
 
 int main() {
     std::cout << "Running all tests...\n";
     VectorTests::runVectorTest();
+    BitVectorTests::runBitVectorTest();
     UnorderedMapTests::runUnorderedMapTest();
     StringTests::runStringTest();
     BitUtilsTests::runBitUtilsTest();
+    BitKernelsTests::runBitKernelsTest();
     FileIOTests::runFileIOTest();
     ScopedTimerTests::runScopedTimerTest();
     TableTests::runTableTest();
     DataTests::runDataTest();
     EncoderTests::runEncoderTest();
     DecoderTests::runDecoderTest();
+    DataReaderTests::runDataReaderTest();
+    EncoderContextTests::runEncoderContextTest();
+    DecoderContextTests::runDecoderContextTest();
+    ArenaTests::runArenaTest();
+    ProfilerTests::runProfilerTest();
 
     std::cout << "All tests completed.\n";
     return 0;